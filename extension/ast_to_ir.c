@@ -53,12 +53,13 @@ static void flow_to_ir(IRProgram *program, FlowStmt *flow_stmt, State *state, in
         if (flow_stmt->expression != NULL) {
             AssignmentStmt *assign = create_assignment_stmt("ret", flow_stmt->expression);
             assignment_to_ir(program, assign, state, line, count_update);
+            assign->expression = NULL; // still owned by the flow statement
             free_assignment_stmt(assign);
         }
-        //  Jump to return address
-        IRInstruction *branch_to_func_call = create_ir_instruction(IR_BR, RP, NOT_USED, NOT_USED, NOT_USED, line);
-        branch_to_func_call->dest->type = REGX;
-        insert_instruction(program, branch_to_func_call, count_update);
+        // Return to the address bl left in RP, restored from the frame record
+        pop_frame(program, line);
+        IRInstruction *return_to_caller = create_ir_instruction(IR_RET, NOT_USED, NOT_USED, NOT_USED, NOT_USED, line);
+        insert_instruction(program, return_to_caller, count_update);
     } else { // Break / Continue statement
         IRInstruction *flow_instr = create_ir_instruction(IR_B, 0, NOT_USED, NOT_USED, NOT_USED, line);
         flow_instr->dest->type = LABEL;
@@ -67,6 +68,52 @@ static void flow_to_ir(IRProgram *program, FlowStmt *flow_stmt, State *state, in
 }
 
 
+// Position of the only set bit of value, -1 unless it is a power of two
+static int single_bit(int64_t value)
+{
+    if (value <= 0 || (value & (value - 1)) != 0) return -1;
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+}
+
+// Branch taken when the condition is false, returning the label token to fill in later
+// Comparisons with zero become cbz/cbnz and tests of a single bit tbz/tbnz, neither setting the flags
+static Token *condition_to_ir(IRProgram *program, BinaryOp *binary_op, State *state, int *line, int count_update)
+{
+    bool is_eq = !strcmp(binary_op->op, "==");
+    bool is_ne = !strcmp(binary_op->op, "!=");
+    Expression *left = binary_op->left;
+    Expression *right = binary_op->right;
+    if ((is_eq || is_ne) && right->tag == EXPR_INT && right->int_value->value == 0) {
+        if (left->tag == EXPR_BINARY_OP && !strcmp(left->binary_op->op, "&")
+            && left->binary_op->right->tag == EXPR_INT && single_bit(left->binary_op->right->int_value->value) >= 0) {
+            // x & (1 << n) == 0
+            int bit = single_bit(left->binary_op->right->int_value->value);
+            uint8_t reg = eval_expression(program, left->binary_op->left, state, line, count_update);
+            IRInstruction *branch = create_ir_instruction(is_eq ? IR_TBNZ : IR_TBZ, reg, bit, 0, NOT_USED, line);
+            branch->dest->type = (bit < 32) ? REGW : REGX;
+            branch->src1->type = IMM;
+            branch->src2->type = LABEL;
+            insert_instruction(program, branch, count_update);
+            return branch->src2;
+        }
+        uint8_t reg = eval_expression(program, left, state, line, count_update);
+        IRInstruction *branch = create_ir_instruction(is_eq ? IR_CBNZ : IR_CBZ, reg, 0, NOT_USED, NOT_USED, line);
+        branch->dest->type = get_register_type(reg);
+        branch->src1->type = LABEL;
+        insert_instruction(program, branch, count_update);
+        return branch->src1;
+    }
+
+    compare_to_ir(program, binary_op, state, line, count_update);
+    IRInstruction *condition2 = create_ir_instruction(IR_BCOND, get_negated_comparison(binary_op), 0, NOT_USED, NOT_USED, line);
+    condition2->dest->type = BC;
+    condition2->src1->type = LABEL;
+    insert_instruction(program, condition2, count_update);
+    return condition2->src1;
+}
+
 static void for_to_ir(IRProgram *program, ForStmt *for_stmt, State *state, int *line, int count_update)
 {
     Arguments *args = for_stmt->range->function_call->args;
@@ -123,6 +170,7 @@ static void for_to_ir(IRProgram *program, ForStmt *for_stmt, State *state, int *
     add_label(state, *line, NULL);
     condition2->src1->value = get_label_address(state);
 
+    assign->expression = NULL; // still owned by the range call
     free_assignment_stmt(assign);
 }
 
@@ -132,24 +180,7 @@ static void while_to_ir(IRProgram *program, WhileStmt *while_stmt, State *state,
 
     // Condition check
     int line_to_return = *line;
-    BinaryOp *binary_op = while_stmt->condition->binary_op;
-    uint8_t left_op = eval_expression(program, binary_op->left, state, line, count_update);
-    IRInstruction *condition;
-    if (binary_op->right->tag == EXPR_INT && binary_op->right->int_value->value < MOVZ_MAX) {
-        condition = create_ir_instruction(IR_CMP, left_op, binary_op->right->int_value->value, NOT_USED, NOT_USED, line);
-        condition->dest->type = REGW;
-        condition->src1->type = IMM;
-    } else {
-        uint8_t right_op = eval_expression(program, binary_op->right, state, line, count_update);
-        condition = create_ir_instruction(IR_CMP, left_op, right_op, NOT_USED, NOT_USED, line);
-        condition->dest->type = get_operation_type(&left_op, &right_op, NULL);
-        condition->src1->type = get_operation_type(&left_op, &right_op, NULL);
-    }
-    insert_instruction(program, condition, count_update);
-
-    IRInstruction *condition2 = create_ir_instruction(IR_BCOND, get_negated_comparison(binary_op), 0, NOT_USED, NOT_USED, line);
-    condition2->dest->type = BC;
-    insert_instruction(program, condition2, count_update);
+    Token *exit_label = condition_to_ir(program, while_stmt->condition->binary_op, state, line, count_update);
 
     // Convert block statements to IR
     statements_to_ir(program, while_stmt->block, state, line, count_update);
@@ -162,33 +193,97 @@ static void while_to_ir(IRProgram *program, WhileStmt *while_stmt, State *state,
 
     // Update branch condition location
     add_label(state, *line, NULL);
-    condition2->src1->value = get_label_address(state);
-    condition2->src1->type = LABEL;
+    exit_label->value = get_label_address(state);
 }
 
-static void if_to_ir(IRProgram *program, IfStmt *if_stmt, State *state, int *line, int count_update)
+// The assignment a block consists of, NULL unless it is a single one of a name or a small int
+static AssignmentStmt *single_assignment(Statements *block)
 {
-    // Condition check
+    if (block == NULL || block->next != NULL || block->statement->tag != ASSIGNMENT_STMT) return NULL;
+    AssignmentStmt *assign = block->statement->assignment_stmt;
+    Expression *value = assign->expression;
+    if (!strncmp(assign->name, "GPIO_", 5)) return NULL;
+    if (value->tag == EXPR_NAME) return assign;
+    if (value->tag == EXPR_INT && value->int_value->value < MAX_MOVE_VALUE) return assign;
+    return NULL;
+}
+
+static bool is_name(Expression *expression, const char *name)
+{
+    return expression->tag == EXPR_NAME && !strcmp(expression->name->name, name);
+}
+
+// Register holding a name or a small int, which moving into does not touch the flags
+static uint8_t value_to_ir(IRProgram *program, Expression *value, int reg, State *state, int *line, int count_update)
+{
+    if (value->tag == EXPR_NAME) {
+        uint8_t src = get_register(state, value->name->name);
+        if (reg != NOT_USED && reg != src) {
+            IRInstruction *instr = create_ir_instruction(IR_MOV, reg, src, NOT_USED, NOT_USED, line);
+            instr->dest->type = REGX;
+            instr->src1->type = REGX;
+            insert_instruction(program, instr, count_update);
+            update_state(state, reg, registers[src]);
+            return reg;
+        }
+        return src;
+    }
+    if (reg == NOT_USED) reg = get_free_intermediary_register(state);
+    IRInstruction *instr = create_ir_instruction(IR_MOVZ, reg, value->int_value->value, NOT_USED, NOT_USED, line);
+    instr->dest->type = REGW;
+    instr->src1->type = IMM;
+    insert_instruction(program, instr, count_update);
+    update_state(state, reg, value->int_value->value);
+    return reg;
+}
+
+// An if whose blocks each assign a name or a small int to the same variable, with no else keeping it,
+// becomes cmp + csel instead of a compare and two branches
+static bool select_to_ir(IRProgram *program, IfStmt *if_stmt, State *state, int *line, int count_update)
+{
+    AssignmentStmt *then_assign = single_assignment(if_stmt->then_block);
+    AssignmentStmt *else_assign = single_assignment(if_stmt->else_block);
+    if (then_assign == NULL || (if_stmt->else_block != NULL && else_assign == NULL)) return false;
+    if (else_assign != NULL && strcmp(then_assign->name, else_assign->name)) return false;
+
+    // Select the value into the variable when the condition holds, else keep the variable
+    char *name = then_assign->name;
+    Expression *value = then_assign->expression;
+    Expression *other = (else_assign != NULL) ? else_assign->expression : NULL;
     BinaryOp *binary_op = if_stmt->condition->binary_op;
-    uint8_t left_op = eval_expression(program, binary_op->left, state, line, count_update);
+    BranchConditional cond = get_comparison(binary_op);
+    if (is_name(value, name) && other != NULL) { // x = x, so keep x on the condition failing instead
+        value = other;
+        other = NULL;
+        cond = get_negated_comparison(binary_op);
+    }
+    if (other != NULL && is_name(other, name)) other = NULL;
 
-    IRInstruction *condition;
-    if (binary_op->right->tag == EXPR_INT && binary_op->right->int_value->value < MOVZ_MAX) {
-        condition = create_ir_instruction(IR_CMP, left_op, binary_op->right->int_value->value, NOT_USED, NOT_USED, line);
-        condition->dest->type = REGW;
-        condition->src1->type = IMM;
-    } else {
-        uint8_t right_op = eval_expression(program, binary_op->right, state, line, count_update);
-        condition = create_ir_instruction(IR_CMP, left_op, right_op, NOT_USED, NOT_USED, line);
-        condition->dest->type = get_operation_type(&left_op, &right_op, NULL);
-        condition->src1->type = get_operation_type(&left_op, &right_op, NULL);
+    compare_to_ir(program, binary_op, state, line, count_update);
+    uint8_t reg = (strcmp(name, "ret") == 0) ? X0 : get_register(state, name);
+    if (other != NULL) {
+        value_to_ir(program, other, reg, state, line, count_update);
     }
-    insert_instruction(program, condition, count_update);
+    int64_t kept = registers[reg];
+    uint8_t value_reg = value_to_ir(program, value, NOT_USED, state, line, count_update);
+
+    IRInstruction *instr = create_ir_instruction(IR_CSEL, reg, value_reg, reg, cond, line);
+    instr->dest->type = get_operation_type(&reg, &value_reg, NULL);
+    instr->src1->type = instr->dest->type;
+    instr->src2->type = instr->dest->type;
+    instr->src3->type = BC;
+    insert_instruction(program, instr, count_update);
+    update_state(state, reg, (registers[value_reg] > kept) ? registers[value_reg] : kept);
+    free_intermediary_register(state, value_reg);
+    return true;
+}
 
-    IRInstruction *condition2 = create_ir_instruction(IR_BCOND, get_negated_comparison(binary_op), 0, NOT_USED, NOT_USED, line);
-    condition2->dest->type = BC;
-    condition2->src1->type = LABEL;
-    insert_instruction(program, condition2, count_update);
+static void if_to_ir(IRProgram *program, IfStmt *if_stmt, State *state, int *line, int count_update)
+{
+    if (select_to_ir(program, if_stmt, state, line, count_update)) return;
+
+    // Condition check
+    Token *else_label = condition_to_ir(program, if_stmt->condition->binary_op, state, line, count_update);
 
     // Then block
     statements_to_ir(program, if_stmt->then_block, state, line, count_update);
@@ -200,7 +295,7 @@ static void if_to_ir(IRProgram *program, IfStmt *if_stmt, State *state, int *lin
 
     // Update branch condition location for the else block
     add_label(state, *line, NULL);
-    condition2->src1->value = get_label_address(state);
+    else_label->value = get_label_address(state);
 
     // Else block
     statements_to_ir(program, if_stmt->else_block, state, line, count_update);
@@ -212,8 +307,9 @@ static void if_to_ir(IRProgram *program, IfStmt *if_stmt, State *state, int *lin
 
 static void function_def_to_ir(IRProgram *program, FunctionDef *function_def, State *state, int *line, int count_update)
 {
-    // Add function to the state
+    // Add function to the state, saving FP and RP in its frame record
     add_fun(state, *line, function_def->name);
+    push_frame(program, line);
     
     // Create self-contained callee state
     State *callee_state = create_state();
@@ -305,12 +401,19 @@ IRProgram *ast_to_ir(Program *prog, State *state)
     add_label(state, line, "main");
     branch_to_main->dest->value = get_label_address(state);
 
-    // Set up SP
+    // Set up SP, which ldr cannot load as register 31 is the zero register there
     push_directive(state, state->stack_pointer, "stack_pointer");
-    IRInstruction *set_sp = create_ir_instruction(IR_LDR, SP, get_directive_address(state), NOT_USED, NOT_USED, &line);
+    uint8_t sp_reg = get_free_register();
+    IRInstruction *load_sp = create_ir_instruction(IR_LDR, sp_reg, get_directive_address(state), NOT_USED, NOT_USED, &line);
+    load_sp->dest->type = REGX;
+    load_sp->src1->type = DIR;
+    insert_instruction(program, load_sp, INITIAL_COUNT);
+    IRInstruction *set_sp = create_ir_instruction(IR_ADD, SP, sp_reg, 0, NOT_USED, &line);
     set_sp->dest->type = REGX;
-    set_sp->src1->type = DIR;
+    set_sp->src1->type = REGX;
+    set_sp->src2->type = IMM;
     insert_instruction(program, set_sp, INITIAL_COUNT);
+    free_register(state, sp_reg);
 
     // Traverse the main function
     statements_to_ir(program, prog->statements, state, &line, INITIAL_COUNT);
@@ -13,6 +13,204 @@
 
 extern int64_t registers[NUM_REGISTERS];
 
+// Set the flags by comparing the operands of a comparison, against an immediate when the right one is small
+void compare_to_ir(IRProgram *program, BinaryOp *binary_op, State *state, int *line, int count_update)
+{
+    Expression *right = binary_op->right;
+    uint8_t left_op = eval_expression(program, binary_op->left, state, line, count_update);
+    IRInstruction *condition;
+    if (right->tag == EXPR_INT && right->int_value->value < MOVZ_MAX) {
+        condition = create_ir_instruction(IR_CMP, left_op, right->int_value->value, NOT_USED, NOT_USED, line);
+        condition->dest->type = REGW;
+        condition->src1->type = IMM;
+    } else {
+        uint8_t right_op = eval_expression(program, right, state, line, count_update);
+        condition = create_ir_instruction(IR_CMP, left_op, right_op, NOT_USED, NOT_USED, line);
+        condition->dest->type = get_operation_type(&left_op, &right_op, NULL);
+        condition->src1->type = get_operation_type(&left_op, &right_op, NULL);
+    }
+    insert_instruction(program, condition, count_update);
+}
+
+// Instruction whose last register operand is shifted by amount
+static void shifted_to_ir(IRProgram *program, IRType ir_type, uint8_t dest, uint8_t src1, uint8_t src2,
+                          TokenType shift, int amount, TokenType type, int *line, int count_update)
+{
+    IRInstruction *instr = create_ir_instruction(ir_type, dest, src1, src2, amount, line);
+    instr->dest->type = type;
+    instr->src1->type = type;
+    instr->src2->type = type;
+    instr->src3->type = shift;
+    insert_instruction(program, instr, count_update);
+}
+
+// Register holding an int, by movz when small enough and a literal otherwise
+static void constant_to_ir(IRProgram *program, uint8_t reg, int64_t value, State *state, int *line, int count_update)
+{
+    IRInstruction *instr;
+    if (value >= 0 && value < MAX_MOVE_VALUE) {
+        instr = create_ir_instruction(IR_MOVZ, reg, value, NOT_USED, NOT_USED, line);
+        instr->dest->type = REGW;
+        instr->src1->type = IMM;
+    } else {
+        push_directive(state, value, NULL);
+        instr = create_ir_instruction(IR_LDR, reg, get_directive_address(state), NOT_USED, NOT_USED, line);
+        instr->dest->type = REGX;
+        instr->src1->type = DIR;
+    }
+    insert_instruction(program, instr, count_update);
+}
+
+// The divisor is an int, or a negated one
+static bool is_constant_divisor(Expression *right, int64_t *divisor)
+{
+    if (right->tag == EXPR_INT) {
+        *divisor = right->int_value->value;
+        return *divisor != 0;
+    }
+    if (right->tag == EXPR_UNARY_OP && right->unary_op->op[0] == '-' && right->unary_op->expression->tag == EXPR_INT) {
+        *divisor = -right->unary_op->expression->int_value->value;
+        return *divisor != 0;
+    }
+    return false;
+}
+
+/*
+ * Quotient of n by a constant divisor d, rounded towards zero as sdiv does, without dividing
+ * Powers of two add the sign bits as a bias before shifting right
+ * Other 32-bit divisors multiply by a magic number of 33 bits, the reciprocal rounded up
+ * Returns NOT_USED when the divisor has no such sequence
+*/
+static int constant_quotient(IRProgram *program, uint8_t n, int64_t d, bool modulo, State *state, int *line, int count_update)
+{
+    TokenType type = get_register_type(n);
+    int bits = (type == REGW) ? 32 : 64;
+    uint64_t a = (d < 0) ? -(uint64_t) d : (uint64_t) d;
+    int k = 0;
+    while (k < 63 && ((uint64_t) 1 << (k + 1)) <= a) {
+        k++;
+    }
+    uint8_t q;
+    if (a == 1) {
+        q = n;
+    } else if (a == ((uint64_t) 1 << k) && k < bits) {
+        uint8_t t = get_scratch_register(state, 1u << n);
+        shifted_to_ir(program, IR_ADD, t, ZR, n, ASR, bits - 1, type, line, count_update);
+        shifted_to_ir(program, IR_ADD, t, n, t, LSR, bits - k, type, line, count_update);
+        q = t;
+        shifted_to_ir(program, IR_ADD, q, ZR, t, ASR, k, type, line, count_update);
+    } else if (type == REGW && a < ((uint64_t) 1 << 31)) {
+        // s = 32 + floor(log2 a) and m = floor(2^s / a) + 1 give the quotient of every 32-bit n
+        int s = 32 + k;
+        int64_t magic = (int64_t) ((((uint64_t) 1 << s) / a) + 1);
+        uint8_t t = get_scratch_register(state, 1u << n);
+        uint8_t m = get_scratch_register(state, (1u << n) | (1u << t));
+        shifted_to_ir(program, IR_ADD, t, ZR, n, LSL, 32, REGX, line, count_update);
+        shifted_to_ir(program, IR_ADD, t, ZR, t, ASR, 32, REGX, line, count_update);
+        constant_to_ir(program, m, magic, state, line, count_update);
+        IRInstruction *mul = create_ir_instruction(IR_MUL, m, t, m, NOT_USED, line);
+        mul->dest->type = REGX;
+        mul->src1->type = REGX;
+        mul->src2->type = REGX;
+        insert_instruction(program, mul, count_update);
+        shifted_to_ir(program, IR_ADD, m, ZR, m, ASR, s, REGX, line, count_update);
+        // The product rounds down, so negative dividends add one to round towards zero
+        shifted_to_ir(program, IR_SUB, m, m, t, ASR, 31, REGW, line, count_update);
+        free_intermediary_register(state, t);
+        q = m;
+    } else {
+        return NOT_USED;
+    }
+    // The remainder takes the sign of the dividend, whatever the sign of the divisor
+    if (d < 0 && !modulo) {
+        uint8_t dest = (q == n) ? get_scratch_register(state, 1u << n) : q;
+        IRInstruction *neg = create_ir_instruction(IR_NEG, dest, q, NOT_USED, NOT_USED, line);
+        neg->dest->type = type;
+        neg->src1->type = type;
+        insert_instruction(program, neg, count_update);
+        q = dest;
+    }
+    return q;
+}
+
+/*
+ * Division and modulo, as sdiv and msub, rounding towards zero like constant folding does
+ * Constant divisors avoid the divide, see constant_quotient
+*/
+static uint8_t divide_to_ir(IRProgram *program, BinaryOp *binary_op, bool modulo, State *state, int *line, int count_update)
+{
+    uint8_t n = eval_expression(program, binary_op->left, state, line, count_update);
+    int64_t value = registers[n]; // the result is no wider than the dividend
+    TokenType type = get_register_type(n);
+    int64_t d;
+    if (is_constant_divisor(binary_op->right, &d)) {
+        int q = constant_quotient(program, n, d, modulo, state, line, count_update);
+        if (q != NOT_USED && !modulo) {
+            if (q != n) {
+                free_intermediary_register(state, n);
+            }
+            update_state(state, q, value);
+            return q;
+        }
+        if (q != NOT_USED) {
+            uint64_t a = (d < 0) ? -(uint64_t) d : (uint64_t) d;
+            uint8_t dest = get_scratch_register(state, (1u << n) | (1u << q));
+            IRInstruction *instr;
+            if (a == 1) {
+                instr = create_ir_instruction(IR_MOVZ, dest, 0, NOT_USED, NOT_USED, line);
+                instr->dest->type = type;
+                instr->src1->type = IMM;
+                insert_instruction(program, instr, count_update);
+            } else if ((a & (a - 1)) == 0) {
+                int k = 0;
+                while (((uint64_t) 1 << k) < a) {
+                    k++;
+                }
+                shifted_to_ir(program, IR_SUB, dest, n, q, LSL, k, type, line, count_update);
+            } else {
+                uint8_t c = get_scratch_register(state, (1u << n) | (1u << q) | (1u << dest));
+                constant_to_ir(program, c, a, state, line, count_update);
+                instr = create_ir_instruction(IR_MSUB, dest, q, c, n, line);
+                instr->dest->type = type;
+                instr->src1->type = type;
+                instr->src2->type = type;
+                instr->src3->type = type;
+                insert_instruction(program, instr, count_update);
+                free_intermediary_register(state, c);
+            }
+            if (q != n) {
+                free_intermediary_register(state, q);
+            }
+            free_intermediary_register(state, n);
+            update_state(state, dest, value);
+            return dest;
+        }
+    }
+    uint8_t m = eval_expression(program, binary_op->right, state, line, count_update);
+    type = get_operation_type(&n, &m, NULL);
+    uint8_t q = get_scratch_register(state, (1u << n) | (1u << m));
+    IRInstruction *instr = create_ir_instruction(IR_SDIV, q, n, m, NOT_USED, line);
+    instr->dest->type = type;
+    instr->src1->type = type;
+    instr->src2->type = type;
+    insert_instruction(program, instr, count_update);
+    uint8_t dest = q;
+    if (modulo) {
+        dest = get_scratch_register(state, (1u << n) | (1u << m) | (1u << q));
+        instr = create_ir_instruction(IR_MSUB, dest, q, m, n, line);
+        instr->dest->type = type;
+        instr->src1->type = type;
+        instr->src2->type = type;
+        instr->src3->type = type;
+        insert_instruction(program, instr, count_update);
+        free_intermediary_register(state, q);
+    }
+    free_intermediary_register(state, n);
+    free_intermediary_register(state, m);
+    update_state(state, dest, value);
+    return dest;
+}
+
 /*
  * Evaluate expression
  * Assume that we can always compute the value
@@ -44,12 +242,26 @@ uint8_t eval_expression(IRProgram *program, Expression *expression, State *state
             return reg;
         }
         case EXPR_BINARY_OP: {
+            if (is_comparison(expression->binary_op->op)) {
+                // The comparisons const_prop cannot fold are 1 or 0 at run time, by cmp and cset
+                compare_to_ir(program, expression->binary_op, state, line, count_update);
+                uint8_t dest_reg = get_free_intermediary_register(state);
+                IRInstruction *instr = create_ir_instruction(IR_CSET, dest_reg, get_comparison(expression->binary_op), NOT_USED, NOT_USED, line);
+                instr->dest->type = REGW;
+                instr->src1->type = BC;
+                insert_instruction(program, instr, count_update);
+                update_state(state, dest_reg, 1);
+                return dest_reg;
+            }
+            char *op = expression->binary_op->op;
+            if (!strcmp(op, "/") || !strcmp(op, "/=") || !strcmp(op, "%") || !strcmp(op, "%=")) {
+                return divide_to_ir(program, expression->binary_op, op[0] == '%', state, line, count_update);
+            }
             IRType type;
             uint8_t left_reg = eval_expression(program, expression->binary_op->left, state, line, count_update);
             uint8_t right_reg = eval_expression(program, expression->binary_op->right, state, line, count_update);
             uint8_t dest_reg = get_free_intermediary_register(state);
-            char *op = expression->binary_op->op;
-            // Do not support / and % yet,nor << and >> yet
+            // Do not support << and >> yet
             if(strcmp(op, "+") == 0) {
                 type = IR_ADD;
                 update_state(state, dest_reg, left_reg + right_reg);
@@ -102,12 +314,6 @@ uint8_t eval_expression(IRProgram *program, Expression *expression, State *state
             if (check_loop_call(program, expression->function_call, state, line)) return X0;
 
             int branch_line = get_fun_address(state, expression->function_call->name);
-            // Save return address
-            push_to_stack(program, state, RP, line);
-            IRInstruction *save_return_addr = create_ir_instruction(IR_MOVZ, RP, 8 * (*line + 1), NOT_USED, NOT_USED, line);
-            save_return_addr->dest->type = REGX;
-            save_return_addr->src1->type = IMM;
-            insert_instruction(program, save_return_addr, count_update);
             // Store arguments in registers
             Arguments *args = expression->function_call->args;
             uint8_t arg_reg;
@@ -126,7 +332,7 @@ uint8_t eval_expression(IRProgram *program, Expression *expression, State *state
                     update_state(state, arg_count, registers[arg_reg]);
                 }
                 store_arg->dest->type = REGX;
-                if (arg_count != arg_reg) {
+                if (store_arg->type == IR_MOVZ || arg_count != arg_reg) {
                     insert_instruction(program, store_arg, count_update);
                 } else {
                     free_ir_instruction(store_arg);
@@ -134,8 +340,8 @@ uint8_t eval_expression(IRProgram *program, Expression *expression, State *state
                 args = args->next;
                 arg_count++;
             }
-            // Call function
-            IRInstruction *call_instr = create_ir_instruction(IR_B, branch_line, NOT_USED, NOT_USED, NOT_USED, line);
+            // Call function, linking the return address in RP
+            IRInstruction *call_instr = create_ir_instruction(IR_BL, branch_line, NOT_USED, NOT_USED, NOT_USED, line);
             call_instr->dest->type = LABEL;
             insert_instruction(program, call_instr, count_update);
             // Returning and setting X0 is done by the return statement
@@ -145,9 +351,6 @@ uint8_t eval_expression(IRProgram *program, Expression *expression, State *state
                 restore_register(program, state, arg_count, line);
                 arg_count--;
             }
-
-            // Restore return address
-            pop_from_stack(program, state, RP, line);
             return X0;
         }
         default: {
@@ -7,5 +7,6 @@
 
 // Prototypes
 uint8_t eval_expression(IRProgram *program, Expression *expression, State *state, int *line, int count_update);
+void compare_to_ir(IRProgram *program, BinaryOp *binary_op, State *state, int *line, int count_update);
 
 #endif 
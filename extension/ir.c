@@ -26,7 +26,7 @@ void free_ir_program(IRProgram *program)
     }
 }
 
-Token *create_token(uint8_t value)
+Token *create_token(int value)
 {
     Token *token = malloc(sizeof(Token));
     assert(token != NULL);
@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #define NUM_REGISTERS 31
+#define FP 29 // frame pointer
 #define RP 30 // return pointer
 #define ZR 31
 #define SP 32 // stack pointer
@@ -20,6 +21,7 @@
 #define MEMORY_CAPACITY (1024 * 1024 * 32)
 #define STACK_OFFSET 2048
 #define MAX_STACK_SIZE 32
+#define STACK_SLOT 16 // bytes each push takes, keeping sp 16-byte aligned
 
 #define MOVZ_MAX (1 << 21)
 
@@ -85,15 +87,28 @@ typedef enum {
     IR_MVN,
     // movn, movk can be derived
     IR_MADD,
-    // msub, mneg can be derived
+    IR_MSUB,
+    // mneg can be derived
     IR_MUL,
+    IR_SDIV,
+    // udiv is not needed, values are signed
+    IR_CSEL,
+    IR_CSET,
+    // csinc, csinv, csneg, csetm, cinc, cinv, cneg can be derived
 
     IR_B,
+    IR_BL,
     IR_BR,
+    IR_RET,
     IR_BCOND,
+    IR_CBZ, IR_CBNZ,
+    IR_TBZ, IR_TBNZ,
 
     IR_LDR,
     IR_STR,
+    IR_LDP,
+    IR_STP,
+    // with an immediate after the base register, stores pre-index down by it (push) and loads post-index up by it (pop)
 
     IR_DIR,
     IR_LABEL
@@ -109,7 +124,10 @@ typedef enum {
     REGW,   // register 32-bit
     BC,     // branch conditional type
     DIR,    // directive
-    LABEL   // label address
+    LABEL,  // label address
+    LSL,    // shift of the register before by an immediate
+    LSR,
+    ASR
 } TokenType;
 
 typedef struct {
@@ -148,7 +166,7 @@ typedef struct {
 IRProgram* create_ir_program(void);
 void free_ir_program(IRProgram *program);
 
-Token *create_token(uint8_t value);
+Token *create_token(int value);
 IRInstruction *create_ir_instruction(IRType type, int dest, int src1, int src2, int src3, int *line);
 void free_ir_instruction(IRInstruction *instruction);
 
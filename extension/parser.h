@@ -0,0 +1,158 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_PARSER_H_INCLUDED
+# define YY_YY_PARSER_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    DEC_INTEGER = 258,             /* DEC_INTEGER  */
+    HEX_INTEGER = 259,             /* HEX_INTEGER  */
+    NAME = 260,                    /* NAME  */
+    AND = 261,                     /* AND  */
+    BREAK = 262,                   /* BREAK  */
+    CONTINUE = 263,                /* CONTINUE  */
+    DEF = 264,                     /* DEF  */
+    ELIF = 265,                    /* ELIF  */
+    ELSE = 266,                    /* ELSE  */
+    FALSE = 267,                   /* FALSE  */
+    FOR = 268,                     /* FOR  */
+    GLOBAL = 269,                  /* GLOBAL  */
+    IF = 270,                      /* IF  */
+    IN = 271,                      /* IN  */
+    NOT = 272,                     /* NOT  */
+    OR = 273,                      /* OR  */
+    RETURN = 274,                  /* RETURN  */
+    TRUE = 275,                    /* TRUE  */
+    WHILE = 276,                   /* WHILE  */
+    L_PAREN = 277,                 /* L_PAREN  */
+    R_PAREN = 278,                 /* R_PAREN  */
+    L_BRACE = 279,                 /* L_BRACE  */
+    R_BRACE = 280,                 /* R_BRACE  */
+    COMMA = 281,                   /* COMMA  */
+    COLON = 282,                   /* COLON  */
+    SEMI_COLON = 283,              /* SEMI_COLON  */
+    ASSIGN = 284,                  /* ASSIGN  */
+    NEG = 285,                     /* NEG  */
+    BITWISE_OR = 286,              /* BITWISE_OR  */
+    BITWISE_XOR = 287,             /* BITWISE_XOR  */
+    BITWISE_AND = 288,             /* BITWISE_AND  */
+    LEFT_SHIFT = 289,              /* LEFT_SHIFT  */
+    RIGHT_SHIFT = 290,             /* RIGHT_SHIFT  */
+    ADD = 291,                     /* ADD  */
+    SUB = 292,                     /* SUB  */
+    MUL = 293,                     /* MUL  */
+    DIV = 294,                     /* DIV  */
+    MOD = 295,                     /* MOD  */
+    LT = 296,                      /* LT  */
+    GT = 297,                      /* GT  */
+    EQ = 298,                      /* EQ  */
+    GE = 299,                      /* GE  */
+    LE = 300,                      /* LE  */
+    NE = 301,                      /* NE  */
+    ADD_ASSIGN = 302,              /* ADD_ASSIGN  */
+    SUB_ASSIGN = 303,              /* SUB_ASSIGN  */
+    MUL_ASSIGN = 304,              /* MUL_ASSIGN  */
+    DIV_ASSIGN = 305,              /* DIV_ASSIGN  */
+    MOD_ASSIGN = 306,              /* MOD_ASSIGN  */
+    AND_ASSIGN = 307,              /* AND_ASSIGN  */
+    OR_ASSIGN = 308,               /* OR_ASSIGN  */
+    XOR_ASSIGN = 309,              /* XOR_ASSIGN  */
+    LEFT_SHIFT_ASSIGN = 310,       /* LEFT_SHIFT_ASSIGN  */
+    RIGHT_SHIFT_ASSIGN = 311,      /* RIGHT_SHIFT_ASSIGN  */
+    INDENT = 312,                  /* INDENT  */
+    DEDENT = 313                   /* DEDENT  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 37 "parser.y"
+
+    int64_t num;
+    char *str;
+    struct Program *program;
+    struct Statements *statements;
+    struct Statement *statement;
+    struct AssignmentStmt *assignment_stmt;
+    struct FlowStmt *flow_stmt;
+    struct IfStmt *if_stmt;
+    struct WhileStmt *while_stmt;
+    struct ForStmt *for_stmt;
+    struct FunctionDef *function_def;
+    struct Parameters *parameters;
+    struct Arguments *arguments;
+    struct Expression *expression;
+    struct Name *name;
+    struct Int *int_value;
+    struct BinaryOp *binary_op;
+    struct UnaryOp *unary_op;
+    struct FunctionCall *function_call;
+
+#line 144 "parser.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_PARSER_H_INCLUDED  */
@@ -78,12 +78,24 @@ static void print_mnemonic(IRType type, FILE *output)
         case IR_MOVZ: fprintf(output, "movz"); break;
         case IR_MVN: fprintf(output, "mvn"); break;
         case IR_MADD: fprintf(output, "madd"); break;
+        case IR_MSUB: fprintf(output, "msub"); break;
         case IR_MUL: fprintf(output, "mul"); break;
+        case IR_SDIV: fprintf(output, "sdiv"); break;
+        case IR_CSEL: fprintf(output, "csel"); break;
+        case IR_CSET: fprintf(output, "cset"); break;
         case IR_B: fprintf(output, "b"); break;
+        case IR_BL: fprintf(output, "bl"); break;
         case IR_BR: fprintf(output, "br"); break;
+        case IR_RET: fprintf(output, "ret"); break;
         case IR_BCOND: fprintf(output, "b."); break;
+        case IR_CBZ: fprintf(output, "cbz"); break;
+        case IR_CBNZ: fprintf(output, "cbnz"); break;
+        case IR_TBZ: fprintf(output, "tbz"); break;
+        case IR_TBNZ: fprintf(output, "tbnz"); break;
         case IR_LDR: fprintf(output, "ldr"); break;
         case IR_STR: fprintf(output, "str"); break;
+        case IR_LDP: fprintf(output, "ldp"); break;
+        case IR_STP: fprintf(output, "stp"); break;
         case IR_DIR: fprintf(output, ".int"); break;
         default: perror("Print mnemonic.\n"); exit(EXIT_FAILURE);
     }
@@ -94,26 +106,66 @@ void print_token(State *state, Token *token, FILE *output)
     switch(token->type) {
         case IMM: fprintf(output, "#%d", token->value); break;
         case REGX:
-            if (token->value != 32) fprintf(output, "x%d", token->value);
+            if (token->value == ZR) fprintf(output, "xzr");
+            else if (token->value != 32) fprintf(output, "x%d", token->value);
             else fprintf(output, "sp");
             break;
         case REGW:
-            if (token->value != 32) fprintf(output, "w%d", token->value);
+            if (token->value == ZR) fprintf(output, "wzr");
+            else if (token->value != 32) fprintf(output, "w%d", token->value);
             else fprintf(output, "sp");
             break;
-        case BC: break;
+        case BC: print_branch_condition(token, output); break; // the condition of csel and cset
         case DIR: fprintf(output, "%s", state->directives[token->value]->name); break;
         case LABEL: fprintf(output, "%s", state->symbol_table[token->value]->name); break;
+        case LSL: fprintf(output, "lsl #%d", token->value); break;
+        case LSR: fprintf(output, "lsr #%d", token->value); break;
+        case ASR: fprintf(output, "asr #%d", token->value); break;
         default: perror("Print token.\n"); exit(EXIT_FAILURE);
     }
 }
 
+// Loads and stores, an immediate after the base register pushing with pre-index or popping with post-index
+static void print_transfer(IRInstruction *instr, State *state, FILE *output)
+{
+    bool pair = (instr->type == IR_LDP || instr->type == IR_STP);
+    bool store = (instr->type == IR_STR || instr->type == IR_STP);
+    Token *base = pair ? instr->src2 : instr->src1;
+    Token *offset = pair ? instr->src3 : instr->src2;
+
+    fprintf(output, " ");
+    print_token(state, instr->dest, output);
+    if (pair) {
+        fprintf(output, ", ");
+        print_token(state, instr->src1, output);
+    }
+    fprintf(output, ", ");
+    if (base->type != REGX) { // Literal
+        print_token(state, base, output);
+        return;
+    }
+    fprintf(output, "[");
+    print_token(state, base, output);
+    if (offset == NULL) {
+        fprintf(output, "]");
+    } else if (store) {
+        fprintf(output, ", #-%d]!", offset->value);
+    } else {
+        fprintf(output, "], #%d", offset->value);
+    }
+}
+
 void print_ir_instruction(IRInstruction *instr, State *state, FILE *output)
 {
     if (instr) {
         print_label(state, instr->line, output);
         fprintf(output, "  ");
         print_mnemonic(instr->type, output);
+        if (instr->type == IR_LDR || instr->type == IR_STR || instr->type == IR_LDP || instr->type == IR_STP) {
+            print_transfer(instr, state, output);
+            fprintf(output, "\n");
+            return;
+        }
         if (instr->dest != NULL) {
             if (instr->dest->type == BC) {
                 print_branch_condition(instr->dest, output);
@@ -125,9 +177,7 @@ void print_ir_instruction(IRInstruction *instr, State *state, FILE *output)
         if (instr->src1 != NULL) {
             if (instr->dest->type != BC) fprintf(output, ",");
             fprintf(output, " ");
-            if ((instr->type == IR_STR || instr->type == IR_LDR) && instr->src1->type == REGX) fprintf(output, "[");
             print_token(state, instr->src1, output);
-            if ((instr->type == IR_STR || instr->type == IR_LDR) && instr->src1->type == REGX) fprintf(output, "]");
         }
         if (instr->src2 != NULL) {
             fprintf(output, ", ");
@@ -123,8 +123,8 @@ void wait(IRProgram *program, State *state, int *line, int wait_time)
     sprintf(str, "wait_time%d", *line / 4);
     push_directive(state, wait_time * WAIT_SECOND, str);
 
-    // Load the wait address in a free register
-    uint8_t reg = get_free_register();
+    // Load the wait time in a register no variable lives in
+    uint8_t reg = get_free_intermediary_register(state);
     IRInstruction *wait_load = create_ir_instruction(IR_LDR, reg, get_directive_address(state), NOT_USED, NOT_USED, line);
     wait_load->dest->type = REGX;
     wait_load->src1->type = DIR;
@@ -134,14 +134,15 @@ void wait(IRProgram *program, State *state, int *line, int wait_time)
     // Add label
     sprintf(str, "wait%d", *line / 4);
     add_label(state, *line, str);
-    IRInstruction *subs = create_ir_instruction(IR_SUBS, reg, reg, 1, NOT_USED, line);
-    subs->dest->type = get_register_type(reg);
-    subs->src1->type = get_register_type(reg);
-    insert_instruction(program, subs, wait_time * WAIT_SECOND);
-
-    // Branch to the beginning if the Zero flag is not set
-    IRInstruction *branch = create_ir_instruction(IR_BCOND, B_NE, get_label_address(state), NOT_USED, NOT_USED, line);
-    branch->dest->type = BC;
+    IRInstruction *sub = create_ir_instruction(IR_SUB, reg, reg, 1, NOT_USED, line);
+    sub->dest->type = get_register_type(reg);
+    sub->src1->type = get_register_type(reg);
+    sub->src2->type = IMM;
+    insert_instruction(program, sub, wait_time * WAIT_SECOND);
+
+    // Branch to the beginning until the counter reaches zero
+    IRInstruction *branch = create_ir_instruction(IR_CBNZ, reg, get_label_address(state), NOT_USED, NOT_USED, line);
+    branch->dest->type = get_register_type(reg);
     branch->src1->type = LABEL;
     insert_instruction(program, branch, wait_time * WAIT_SECOND);
 
@@ -150,6 +151,8 @@ void wait(IRProgram *program, State *state, int *line, int wait_time)
 
 void loop_end(IRProgram *program, State *state, int *line, int label_address)
 {
+    // LOOP pushes its frame record again on entry
+    pop_frame(program, line);
     IRInstruction *branch_loop = create_ir_instruction(IR_B, label_address, NOT_USED, NOT_USED, NOT_USED, line);
     branch_loop->dest->type = LABEL;
     insert_instruction(program, branch_loop, 1);
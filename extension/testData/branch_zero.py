@@ -0,0 +1,10 @@
+# a == 0 branches with cbnz, b & 4 == 0 with tbnz, and WAIT counts down with cbnz, b = 8
+a = 0
+b = 5
+if (a == 0):
+    {b = b + 1}
+if (b & 4 == 0):
+    {b = b + 16}
+else:
+    {b = b + 2}
+w = WAIT(1)
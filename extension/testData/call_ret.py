@@ -0,0 +1,5 @@
+# square is called with one bl and returns with ret, y = 49
+def square(n):
+    {return n * n}
+x = 7
+y = square(x)
@@ -0,0 +1,12 @@
+# / 8 and % 8 shift, / 7 and / -3 multiply by a reciprocal, / b and % b use sdiv and msub
+# p = 12, q = 4, r = 14, s = 2, t = -33, u = 1, v = 11, w = 1
+a = 100
+b = 9
+p = a / 8
+q = a % 8
+r = a / 7
+s = a % 7
+t = a / -3
+u = a % -3
+v = a / b
+w = a % b
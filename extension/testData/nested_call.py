@@ -0,0 +1,7 @@
+# twice calls inc twice, so both save x29 and x30 with stp on entry and restore them with ldp, x = 7
+def inc(n):
+    {return n + 1}
+def twice(n):
+    {n = inc(n)
+    return inc(n)}
+x = twice(5)
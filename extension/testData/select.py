@@ -0,0 +1,8 @@
+# The if/else becomes cmp + csel and a < b as a value becomes cmp + cset, m = 3 and c = 1
+a = 3
+b = 7
+if (a < b):
+    {m = a}
+else:
+    {m = b}
+c = a < b
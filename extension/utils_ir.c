@@ -32,6 +32,12 @@ BranchConditional get_comparison(BinaryOp *binary_op)
     exit(EXIT_FAILURE);
 }
 
+bool is_comparison(const char *op)
+{
+    return !strcmp(op, "==") || !strcmp(op, "!=") || !strcmp(op, ">=")
+        || !strcmp(op, ">") || !strcmp(op, "<=") || !strcmp(op, "<");
+}
+
 BranchConditional get_negated_comparison(BinaryOp *binary_op)
 {
     if (!strcmp(binary_op->op, "==")) {
@@ -97,6 +103,24 @@ uint8_t get_free_intermediary_register(State *state)
     exit(EXIT_FAILURE);
 }
 
+// Intermediary register outside in_use, a mask of the registers still to be read
+uint8_t get_scratch_register(State *state, uint32_t in_use)
+{
+    for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+        bool found = (in_use >> i) & 1;
+        for (int j = 0; j < state->map_size && !found; j++) {
+            if (state->map[j]->reg == i) {
+                found = true;
+            }
+        }
+        if (!found) {
+            registers[i] = 0;
+            return i;
+        }
+    }
+    exit(EXIT_FAILURE);
+}
+
 void free_register(State *state, uint8_t reg) {
     for (uint8_t i = 0; i <= NUM_REGISTERS; i++) {
         int found = 0;
@@ -129,17 +153,6 @@ void free_intermediary_register(State *state, uint8_t reg)
     }
 }
 
-bool used_register(State *state, uint8_t reg)
-{
-    for (int i = 0; i < state->map_size; i++) {
-        if (state->map[i]->reg == reg) {
-            return true;
-        }
-    }
-    // Check for SP
-    return (state->stack_size != 0);
-}
-
 TokenType get_register_type(uint8_t reg)
 {
     return (registers[reg] < (int64_t) INT32_MAX) ? REGW : REGX;
@@ -156,53 +169,65 @@ TokenType get_operation_type(uint8_t *reg1, uint8_t *reg2, uint8_t *reg3)
 
 void push_to_stack(IRProgram *program, State *state, uint8_t reg, int *line)
 {
-    IRInstruction *stack = create_ir_instruction(IR_SUB, SP, SP, 64, NOT_USED, line);
-    stack->dest->type = REGX;
-    stack->src1->type = REGX;
-    stack->src2->type = IMM;
-    insert_instruction(program, stack, 1);
-    IRInstruction *push = create_ir_instruction(IR_STR, reg, SP, NOT_USED, NOT_USED, line);
+    IRInstruction *push = create_ir_instruction(IR_STR, reg, SP, STACK_SLOT, NOT_USED, line);
     push->dest->type = REGX;
     push->src1->type = REGX;
+    push->src2->type = IMM;
     insert_instruction(program, push, 1);
     state->stack[state->stack_size] = 0;
     state->stack_size++;
-    state->stack_pointer -= 64;
+    state->stack_pointer -= STACK_SLOT;
 }
 
 void pop_from_stack(IRProgram *program, State *state, uint8_t reg, int *line)
 {
-    IRInstruction *pop = create_ir_instruction(IR_LDR, reg, SP, NOT_USED, NOT_USED, line);
+    IRInstruction *pop = create_ir_instruction(IR_LDR, reg, SP, STACK_SLOT, NOT_USED, line);
     pop->dest->type = REGX;
     pop->src1->type = REGX;
+    pop->src2->type = IMM;
     insert_instruction(program, pop, 1);
     state->stack[state->stack_size] = registers[reg];
     state->stack_size--;
-    state->stack_pointer += 64;
-    IRInstruction *stack = create_ir_instruction(IR_ADD, SP, SP, 64, NOT_USED, line);
-    stack->dest->type = REGX;
-    stack->src1->type = REGX;
-    stack->src2->type = IMM;
-    insert_instruction(program, stack, 1);
+    state->stack_pointer += STACK_SLOT;
+}
+
+// Frame record of a function: save FP and RP on entry, as the calls it makes overwrite RP
+void push_frame(IRProgram *program, int *line)
+{
+    IRInstruction *push = create_ir_instruction(IR_STP, FP, RP, SP, STACK_SLOT, line);
+    push->dest->type = REGX;
+    push->src1->type = REGX;
+    push->src2->type = REGX;
+    push->src3->type = IMM;
+    insert_instruction(program, push, 1);
+}
+
+// Restore FP and RP before returning
+void pop_frame(IRProgram *program, int *line)
+{
+    IRInstruction *pop = create_ir_instruction(IR_LDP, FP, RP, SP, STACK_SLOT, line);
+    pop->dest->type = REGX;
+    pop->src1->type = REGX;
+    pop->src2->type = REGX;
+    pop->src3->type = IMM;
+    insert_instruction(program, pop, 1);
 }
 
 void save_register(IRProgram *program, State *state, uint8_t reg, int *line)
 {
-    // Save in caller/calle saved
-    if (used_register(state, reg)) {
-        push_to_stack(program, state, reg + 8, line);
-        IRInstruction *call_saved = create_ir_instruction(IR_MOV, reg + 8, reg, NOT_USED, NOT_USED, line);
-        call_saved->dest->type = REGX;
-        call_saved->src1->type = REGX;
-        insert_instruction(program, call_saved, 0);
-    }
+    // Save in caller/calle saved, the argument register may hold a variable or a partial result
+    push_to_stack(program, state, reg + 8, line);
+    IRInstruction *call_saved = create_ir_instruction(IR_MOV, reg + 8, reg, NOT_USED, NOT_USED, line);
+    call_saved->dest->type = REGX;
+    call_saved->src1->type = REGX;
+    insert_instruction(program, call_saved, 0);
 }
 
 void restore_register(IRProgram *program, State *state, uint8_t reg, int *line)
 {
     // As X0 stores the address, restore X0 in another free register and link it with the variable
     if (reg == X0) {
-        reg = get_free_intermediary_register(state);
+        reg = get_scratch_register(state, 1u << X0);
         for (int i = 0; i < state->map_size; i++) {
             if (state->map[i]->reg == X0) {
                 state->map[i]->reg = reg;
@@ -216,13 +241,11 @@ void restore_register(IRProgram *program, State *state, uint8_t reg, int *line)
         return;
     }
     // Restore from caller/calle saved
-    if (used_register(state, reg)) {
-        IRInstruction *call_saved = create_ir_instruction(IR_MOV, reg, reg + 8, NOT_USED, NOT_USED, line);
-        call_saved->dest->type = REGX;
-        call_saved->src1->type = REGX;
-        insert_instruction(program, call_saved, 0);
-        pop_from_stack(program, state, reg + 8, line);
-    }
+    IRInstruction *call_saved = create_ir_instruction(IR_MOV, reg, reg + 8, NOT_USED, NOT_USED, line);
+    call_saved->dest->type = REGX;
+    call_saved->src1->type = REGX;
+    insert_instruction(program, call_saved, 0);
+    pop_from_stack(program, state, reg + 8, line);
 }
 
 void insert_instruction(IRProgram *program, IRInstruction *instruction, int count_update)
@@ -12,22 +12,25 @@ State *create_state();
 
 BranchConditional get_comparison(BinaryOp *binary_op);
 BranchConditional get_negated_comparison(BinaryOp *binary_op);
+bool is_comparison(const char *op);
 
 uint8_t get_register(State *state, char *name);
 uint8_t get_free_register(void);
 uint8_t get_free_intermediary_register(State *state);
+uint8_t get_scratch_register(State *state, uint32_t in_use);
 void free_register(State *state, uint8_t i);
 void free_intermediary_register(State *state, uint8_t reg);
 void insert_instruction(IRProgram *program, IRInstruction *instruction, int count_update);
 void insert_program(IRProgram *program, IRProgram *block);
 int64_t get_var_value(State *state, char *name);
-bool used_register(State *state, uint8_t reg);
 
 TokenType get_register_type(uint8_t reg);
 TokenType get_operation_type(uint8_t *reg1, uint8_t *reg2, uint8_t *reg3);
 
 void push_to_stack(IRProgram *program, State *state, uint8_t reg, int *line);
 void pop_from_stack(IRProgram *program, State *state, uint8_t reg, int *line);
+void push_frame(IRProgram *program, int *line);
+void pop_frame(IRProgram *program, int *line);
 void save_register(IRProgram *program, State *state, uint8_t reg, int *line);
 void restore_register(IRProgram *program, State *state, uint8_t reg, int *line);
 
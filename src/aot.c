@@ -0,0 +1,603 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "decoders.h"
+#include "format.h"
+#include "io.h"
+#include "structs.h"
+#include "utils_em.h"
+
+#define NUM_WORDS (MEMORY_SIZE / INSTR_BYTES)
+#define BYTES_PER_LINE 12
+#define NUM_NAMES 4 // register names alive in one emitted statement
+
+
+// Translates a flat binary to a C program running it natively: every basic block reachable from
+// address 0 becomes a function returning the address of its successor, and a dispatcher maps
+// addresses to blocks. Build the output with
+//     cc -O2 -I src out.c src/libemulate.a -pthread
+// Memory, devices and the flags are those of the emulator library, so the translated program
+// writes the same final state as emulate. Code that stores over itself cannot run translated,
+// and register branches may only reach the starts of blocks: the targets of direct branches,
+// the instructions after them and the return addresses loaded by movz for a call.
+
+// Words of the program found to be code, the addresses starting a block and the halt instructions
+static bool code[NUM_WORDS];
+static bool leaders[NUM_WORDS];
+static bool halts[NUM_WORDS];
+static bool hasStores = false; // whether the generated code needs checkStore
+static uint32_t worklist[NUM_WORDS];
+static size_t pending = 0;
+
+static const uint8_t *program;
+static size_t programSize;
+
+// Little-endian word of the program at addr, 0 beyond its end as in the emulator memory
+static uint32_t wordAt(uint64_t addr)
+{
+    uint32_t word = 0;
+    for (int i = 0; i < INSTR_BYTES && addr + i < programSize; i++) {
+        word |= (uint32_t)program[addr + i] << (BYTE_SIZE * i);
+    }
+    return word;
+}
+
+// Queue addr as the start of a block, ignoring addresses outside the translated memory
+static void addLeader(uint64_t addr)
+{
+    if (addr >= MEMORY_SIZE || addr % INSTR_BYTES != 0 || leaders[addr / INSTR_BYTES]) {
+        return;
+    }
+    leaders[addr / INSTR_BYTES] = true;
+    worklist[pending++] = addr;
+}
+
+// Whether the word before addr is an unconditional branch, as it is before a return address
+static bool followsCall(uint64_t addr)
+{
+    if (addr < INSTR_BYTES || addr > programSize) {
+        return false;
+    }
+    uint32_t word = wordAt(addr - INSTR_BYTES);
+    Instruction instruction = { .instructionType = isDPI };
+    return isDecodable(word) && !decode(&word, &instruction, getBits) && instruction.instructionType == isB
+        && instruction.b.type == BRANCH_UNCONDITIONAL;
+}
+
+// Follow the instructions from addr to the end of their block, queueing its successors
+static void explore(uint64_t addr)
+{
+    for (; addr < MEMORY_SIZE && !code[addr / INSTR_BYTES]; addr += INSTR_BYTES) {
+        code[addr / INSTR_BYTES] = true;
+        uint32_t word = wordAt(addr);
+        if (word == HALT_INSTR) {
+            halts[addr / INSTR_BYTES] = true;
+            return;
+        }
+        Instruction instruction = { .instructionType = isDPI };
+        if (!isDecodable(word) || decode(&word, &instruction, getBits)) {
+            return; // Raises the undefined instruction error once reached
+        }
+        if (instruction.instructionType == isSDT && instruction.sdt.l == 0
+            && (instruction.sdt.pair || instruction.sdt.mode == 1)) {
+            hasStores = true;
+        }
+        if (instruction.instructionType == isDPI && instruction.dpi.opi == WIDEMOVE
+            && instruction.dpi.opc == MOVE_WITH_ZERO && instruction.dpi.hw == 0
+            && followsCall(instruction.dpi.imm16)) {
+            addLeader(instruction.dpi.imm16);
+        }
+        if (instruction.instructionType == isB) {
+            struct B b = instruction.b;
+            if (b.type == BRANCH_UNCONDITIONAL) {
+                addLeader(addr + (int64_t)b.simm26 * INSTR_BYTES);
+            } else if (b.type == BRANCH_LINK) { // The callee returns to the next instruction
+                addLeader(addr + (int64_t)b.simm26 * INSTR_BYTES);
+                addLeader(addr + INSTR_BYTES);
+            } else if (b.type == BRANCH_REGISTER && b.opc == BLR_OPC) {
+                addLeader(addr + INSTR_BYTES);
+            } else if (b.type == BRANCH_CONDITIONAL) {
+                addLeader(addr + (int64_t)b.simm19 * INSTR_BYTES);
+                addLeader(addr + INSTR_BYTES);
+            } else if (b.type == BRANCH_COMPARE || b.type == BRANCH_TEST) {
+                addLeader(addr + (int64_t)b.simm * INSTR_BYTES);
+                addLeader(addr + INSTR_BYTES);
+            }
+            return;
+        }
+    }
+}
+
+//
+// Code generation
+//
+// Register n as the interpreter reads it through R[], index 31 being the zero register
+static const char *reg(int n)
+{
+    static char names[NUM_NAMES][sizeof("s->R[00]")];
+    static int next = 0;
+    if (n == ZR_SP) {
+        return "s->ZR";
+    }
+    char *name = names[next++ % NUM_NAMES];
+    snprintf(name, sizeof(names[0]), "s->R[%d]", n);
+    return name;
+}
+
+// Register n where index 31 is the stack pointer
+static const char *regOrSP(int n)
+{
+    return (n == ZR_SP) ? "s->SP" : reg(n);
+}
+
+static void emitMask(FILE *out, bool sf, const char *rd)
+{
+    if (!sf) {
+        fprintf(out, "    %s &= MASK32;\n", rd);
+    }
+}
+
+// The add or subtract of addOrSub, on operands a and b
+static void emitAddOrSub(FILE *out, uint8_t opc, uint8_t rd, bool sf, const char *Rd, const char *b)
+{
+    const char *op = (opc == ADD || opc == ADD_SETFLAGS) ? "+" : "-";
+    switch (opc) {
+        case ADD:
+        case SUB:
+            fprintf(out, "    %s = (int64_t)((uint64_t)a %s (uint64_t)%s);\n", Rd, op, b);
+            break;
+        case ADD_SETFLAGS:
+        case SUB_SETFLAGS:
+            if (rd != ZR_SP) {
+                fprintf(out, "    %s = (int64_t)((uint64_t)a %s (uint64_t)%s);\n", Rd, op, b);
+            }
+            fprintf(out, "    updateFlagsArithmetic(a, %s, %s, %s);\n", b, sf ? "true" : "false",
+                    (opc == ADD_SETFLAGS) ? "true" : "false");
+            break;
+        default:
+            fprintf(out, "    raiseError(EMULATE_ERROR_UNSUPPORTED, \"Unsupported opc of data processing operation.\");\n");
+    }
+}
+
+static void emitDPI(FILE *out, struct DPI dpi)
+{
+    const char *Rd = regOrSP(dpi.rd);
+    switch (dpi.opi) {
+        case ARITHMETIC: {
+            uint64_t imm12 = (uint64_t)dpi.imm12 << (dpi.sh * ARITHMETIC_SHIFT);
+            fprintf(out, "    a = %s;\n", regOrSP(dpi.rn));
+            emitMask(out, dpi.sf, "a");
+            char b[sizeof("0x0000000000000000")];
+            snprintf(b, sizeof(b), "0x%" PRIx64, imm12);
+            emitAddOrSub(out, dpi.opc, dpi.rd, dpi.sf, Rd, b);
+            break;
+        }
+        case WIDEMOVE: {
+            if (dpi.rd == ZR_SP) {
+                break;
+            }
+            uint64_t imm16 = (uint64_t)dpi.imm16 << (dpi.hw * WIDEMOVE_SHIFT);
+            switch (dpi.opc) {
+                case MOVE_WITH_NOT:
+                    fprintf(out, "    %s = (int64_t)0x%" PRIx64 "u;\n", Rd, ~imm16);
+                    break;
+                case MOVE_WITH_ZERO:
+                    fprintf(out, "    %s = 0x%" PRIx64 ";\n", Rd, imm16);
+                    break;
+                case MOVE_WITH_KEEP: {
+                    uint64_t mask = ~((uint64_t)MASK16 << (dpi.hw * WIDEMOVE_SHIFT));
+                    fprintf(out, "    %s = (int64_t)(((uint64_t)%s & 0x%" PRIx64 "u) | 0x%" PRIx64 "u);\n",
+                            Rd, Rd, mask, imm16);
+                    break;
+                }
+                default:
+                    fprintf(out, "    raiseError(EMULATE_ERROR_UNSUPPORTED, \"Unsupported wide move type (bits 29-30), use either 00, 10 or 11.\");\n");
+            }
+            break;
+        }
+        default:
+            fprintf(out, "    raiseError(EMULATE_ERROR_UNSUPPORTED, \"Unsupported opi (bits 23-25), use either 010 or 101.\");\n");
+    }
+    emitMask(out, dpi.sf, Rd);
+}
+
+// The shifted register operand as computed by shift(), the amount known when translating
+static void emitShift(FILE *out, uint8_t mode, int amount, bool sf)
+{
+    amount %= sf ? MODE64 : MODE32;
+    const char *type = sf ? "uint64_t" : "uint32_t";
+    switch (mode) {
+        case LOGICAL_SHIFT_LEFT:
+            fprintf(out, "(int64_t)((%s)b << %d)", type, amount);
+            break;
+        case LOGICAL_SHIFT_RIGHT:
+            fprintf(out, "(int64_t)((%s)b >> %d)", type, amount);
+            break;
+        case ARITHMETIC_SHIFT_RIGHT:
+            if (sf) {
+                fprintf(out, "(b >> %d)", amount);
+            } else {
+                fprintf(out, "(int64_t)(uint32_t)((int32_t)b >> %d)", amount);
+            }
+            break;
+        default: // Rotate right
+            if (amount == 0) {
+                fprintf(out, "b");
+            } else {
+                fprintf(out, "(int64_t)(((%s)b >> %d) | ((%s)b << %d))", type, amount, type,
+                        (sf ? MODE64 : MODE32) - amount);
+            }
+    }
+}
+
+// C expression of a condition on the evaluated flags, NULL after emitting the error of an unsupported one
+static const char *conditionExpression(FILE *out, struct Condition cond)
+{
+    switch (cond.tag) {
+        case EQ_NE_TAG:
+            return "s->pstate.Z";
+        case GE_LT_TAG:
+            return "(s->pstate.N == s->pstate.V)";
+        case GT_LE_TAG:
+            return "(!s->pstate.Z && s->pstate.N == s->pstate.V)";
+        case ALWAYS_TAG:
+            return "true";
+        default:
+            fprintf(out, "    raiseError(EMULATE_ERROR_UNSUPPORTED, \"Unsupported condition (bits 1-3), use either 000, 101, 110 or 111.\");\n");
+            return NULL;
+    }
+}
+
+// csel, csinc, csinv and csneg
+static void emitSelect(FILE *out, struct DPR dpr)
+{
+    const char *condition = conditionExpression(out, dpr.cond);
+    if (condition == NULL || dpr.rd == ZR_SP) {
+        return;
+    }
+    const char *Rd = reg(dpr.rd);
+    const char *transform = (dpr.opc != SELECT_INVERT) ? ((dpr.op2 == SELECT_INCREMENT) ? "+ 1" : "")
+                          : ((dpr.op2 == SELECT_INCREMENT) ? "* -1" : "^ ~0ull");
+    fprintf(out, "    evaluateFlags();\n");
+    fprintf(out, "    %s = (%s%s) ? %s : (int64_t)((uint64_t)%s %s);\n", Rd, dpr.cond.neg ? "!" : "", condition,
+            reg(dpr.rn), reg(dpr.rm), transform);
+    emitMask(out, dpr.sf, Rd);
+}
+
+// udiv and sdiv, as divide() leaves them
+static void emitDivide(FILE *out, struct DPR dpr)
+{
+    if (dpr.rd == ZR_SP) {
+        return;
+    }
+    const char *Rd = reg(dpr.rd);
+    const char *type = dpr.sf ? "int64_t" : "int32_t";
+    const char *unsignedType = dpr.sf ? "uint64_t" : "uint32_t";
+    fprintf(out, "    a = (%s)%s;\n", unsignedType, reg(dpr.rn));
+    fprintf(out, "    b = (%s)%s;\n", unsignedType, reg(dpr.rm));
+    if (dpr.opcode == UDIV_OPCODE) {
+        fprintf(out, "    %s = (b == 0) ? 0 : (int64_t)((uint64_t)a / (uint64_t)b);\n", Rd);
+    } else {
+        fprintf(out, "    %s = (b == 0) ? 0 : ((%s)b == -1) ? (int64_t)(0 - (uint64_t)(%s)a) : (%s)a / (%s)b;\n",
+                Rd, type, type, type, type);
+    }
+    emitMask(out, dpr.sf, Rd);
+}
+
+static void emitDPR(FILE *out, struct DPR dpr)
+{
+    if (dpr.m == 1 && dpr.opr == DPR_DIVIDE) {
+        emitDivide(out, dpr);
+        return;
+    }
+    if (dpr.m == 1 && dpr.opr == DPR_SELECT) {
+        emitSelect(out, dpr);
+        return;
+    }
+    const char *Rd = reg(dpr.rd);
+    // As in the interpreter both operands read the zero register when rm is 31
+    fprintf(out, "    b = %s;\n", reg(dpr.rm));
+    fprintf(out, "    a = %s;\n", (dpr.rm != ZR_SP) ? reg(dpr.rn) : "s->ZR");
+    emitMask(out, dpr.sf, "b");
+    emitMask(out, dpr.sf, "a");
+
+    if (dpr.m == 0) {
+        fprintf(out, "    b = %s", (dpr.armOrLog == 0 && dpr.n == 1) ? "~" : "");
+        emitShift(out, dpr.shift, dpr.operand, dpr.sf);
+        fprintf(out, ";\n");
+        if (dpr.armOrLog == 1) {
+            emitAddOrSub(out, dpr.opc, dpr.rd, dpr.sf, Rd, "b");
+        } else {
+            switch (dpr.opc) {
+                case BITWISE_AND:
+                    fprintf(out, "    %s = a & b;\n", Rd);
+                    break;
+                case BITWISE_OR:
+                    fprintf(out, "    %s = a | b;\n", Rd);
+                    break;
+                case BITWISE_XOR:
+                    fprintf(out, "    %s = a ^ b;\n", Rd);
+                    break;
+                case BITWISE_AND_SETFLAGS:
+                    if (dpr.rd != ZR_SP) {
+                        fprintf(out, "    %s = a & b;\n", Rd);
+                    }
+                    fprintf(out, "    updateFlagsAnd(a, b, %s);\n", dpr.sf ? "true" : "false");
+                    break;
+            }
+        }
+    } else if (dpr.rd != ZR_SP) {
+        fprintf(out, "    %s = (int64_t)((uint64_t)%s %s (uint64_t)a * (uint64_t)b);\n", Rd, reg(dpr.ra),
+                (dpr.x == 0) ? "+" : "-");
+    }
+    emitMask(out, dpr.sf, Rd);
+}
+
+// Load and store pairs, storing before and loading after the base is written back as transferPair does
+static void emitPair(FILE *out, struct SDT sdt)
+{
+    const char *Rt = reg(sdt.rt);
+    const char *Rt2 = reg(sdt.rt2);
+    const char *Xn = regOrSP(sdt.xn);
+    int bytes = sdt.sf ? MODE64_BYTES : MODE32_BYTES;
+    int offset = sdt.simm7 * bytes;
+    fprintf(out, "    addr = (uint64_t)%s + (uint64_t)%d;\n", Xn, (sdt.index == PAIR_POST_INDEX) ? 0 : offset);
+    if (sdt.l == 0) {
+        fprintf(out, "    checkStore(addr, %d);\n", 2 * bytes);
+        fprintf(out, "    writeMemory(addr, %s, %d);\n", Rt, bytes);
+        fprintf(out, "    writeMemory(addr + %d, %s, %d);\n", bytes, Rt2, bytes);
+    }
+    if (sdt.index != PAIR_OFFSET) {
+        fprintf(out, "    %s = (int64_t)((uint64_t)%s + (uint64_t)%d);\n", Xn, Xn, offset);
+    }
+    if (sdt.l == 1) {
+        fprintf(out, "    %s = readMemory(addr, %d);\n", Rt, bytes);
+        fprintf(out, "    %s = readMemory(addr + %d, %d);\n", Rt2, bytes, bytes);
+    }
+}
+
+static void emitSDT(FILE *out, struct SDT sdt, uint64_t pc)
+{
+    if (sdt.pair) {
+        emitPair(out, sdt);
+        return;
+    }
+    const char *Rt = reg(sdt.rt);
+    int bytes = sdt.sf ? MODE64_BYTES : MODE32_BYTES;
+    emitMask(out, sdt.sf, Rt);
+
+    if (sdt.mode == 1) {
+        const char *Xn = regOrSP(sdt.xn);
+        if (sdt.u == 1) {
+            uint16_t offset = sdt.imm12 * bytes;
+            fprintf(out, "    addr = (uint64_t)%s + %u;\n", Xn, offset);
+        } else if (sdt.offmode == 0) {
+            fprintf(out, "    addr = (uint64_t)%s + (uint64_t)%d;\n", Xn, sdt.i ? sdt.simm9 : 0);
+            fprintf(out, "    %s = (int64_t)((uint64_t)%s + (uint64_t)%d);\n", Xn, Xn, sdt.simm9);
+        } else { // The interpreter reads SP instead of xm when xn is 31
+            fprintf(out, "    addr = (uint64_t)%s + (uint64_t)%s;\n", Xn,
+                    (sdt.xn == ZR_SP) ? "s->SP" : reg(sdt.xm));
+        }
+        if (sdt.l == 1) {
+            fprintf(out, "    %s = readMemory(addr, %d);\n", Rt, bytes);
+        } else {
+            fprintf(out, "    checkStore(addr, %d);\n", bytes);
+            fprintf(out, "    writeMemory(addr, %s, %d);\n", Rt, bytes);
+        }
+    } else {
+        uint64_t addr = pc + (int64_t)sdt.simm19 * INSTR_BYTES;
+        fprintf(out, "    %s = readMemory(0x%" PRIx64 "u, %d);\n", Rt, addr, bytes);
+    }
+}
+
+// The branch ending a block, returning the address of the next block
+static void emitB(FILE *out, struct B b, uint64_t pc)
+{
+    switch (b.type) {
+        case BRANCH_UNCONDITIONAL:
+            fprintf(out, "    return 0x%" PRIx64 "u;\n", pc + (int64_t)b.simm26 * INSTR_BYTES);
+            break;
+        case BRANCH_LINK:
+            fprintf(out, "    %s = 0x%" PRIx64 ";\n", reg(LINK_REGISTER), pc + INSTR_BYTES);
+            fprintf(out, "    return 0x%" PRIx64 "u;\n", pc + (int64_t)b.simm26 * INSTR_BYTES);
+            break;
+        case BRANCH_CONDITIONAL: {
+            const char *condition = conditionExpression(out, b.cond);
+            if (condition == NULL) {
+                return;
+            }
+            fprintf(out, "    evaluateFlags();\n");
+            fprintf(out, "    return (%s%s) ? 0x%" PRIx64 "u : 0x%" PRIx64 "u;\n", b.cond.neg ? "!" : "", condition,
+                    pc + (int64_t)b.simm19 * INSTR_BYTES, pc + INSTR_BYTES);
+            break;
+        }
+        case BRANCH_COMPARE:
+            fprintf(out, "    return ((%s%s) %s 0) ? 0x%" PRIx64 "u : 0x%" PRIx64 "u;\n", b.sf ? "" : "(uint32_t)",
+                    reg(b.rt), b.nonzero ? "!=" : "==", pc + (int64_t)b.simm * INSTR_BYTES, pc + INSTR_BYTES);
+            break;
+        case BRANCH_TEST:
+            fprintf(out, "    return (((uint64_t)%s >> %d & 1) %s 0) ? 0x%" PRIx64 "u : 0x%" PRIx64 "u;\n", reg(b.rt),
+                    b.sf * 32 + b.b40, b.nonzero ? "!=" : "==", pc + (int64_t)b.simm * INSTR_BYTES, pc + INSTR_BYTES);
+            break;
+        case BRANCH_REGISTER: // br, blr and ret
+            if (b.opc == BLR_OPC) {
+                fprintf(out, "    uint64_t target = %s;\n", reg(b.xn));
+                fprintf(out, "    %s = 0x%" PRIx64 ";\n", reg(LINK_REGISTER), pc + INSTR_BYTES);
+                fprintf(out, "    return target;\n");
+            } else {
+                fprintf(out, "    return %s;\n", reg(b.xn));
+            }
+            break;
+        default:
+            fprintf(out, "    raiseError(EMULATE_ERROR_UNSUPPORTED, \"Unsupported branch type (bits 30-31).\");\n");
+    }
+}
+
+// Length of the block at start: up to its branch, the halt instruction, an undefined word or the next block
+static int blockLength(uint64_t start)
+{
+    int length = 0;
+    for (uint64_t addr = start; addr < MEMORY_SIZE; addr += INSTR_BYTES) {
+        if (addr != start && leaders[addr / INSTR_BYTES]) {
+            break;
+        }
+        uint32_t word = wordAt(addr);
+        Instruction instruction = { .instructionType = isDPI };
+        if (word == HALT_INSTR || !isDecodable(word) || decode(&word, &instruction, getBits)) {
+            break;
+        }
+        length++;
+        if (instruction.instructionType == isB) {
+            break;
+        }
+    }
+    return length;
+}
+
+static void emitBlock(FILE *out, uint64_t start)
+{
+    fprintf(out, "static uint64_t block_%08" PRIx64 "(void)\n{\n", start);
+    fprintf(out, "    int64_t a, b;\n    uint64_t addr;\n    (void)a, (void)b, (void)addr;\n");
+    int length = blockLength(start);
+    fprintf(out, "    s->retired += %d;\n", length);
+
+    uint64_t addr = start;
+    for (int i = 0; i < length; i++, addr += INSTR_BYTES) {
+        uint32_t word = wordAt(addr);
+        Instruction instruction = { .instructionType = isDPI };
+        decode(&word, &instruction, getBits);
+        char text[MAX_INSTR_TEXT];
+        formatInstruction(&instruction, addr, text, sizeof(text));
+        fprintf(out, "    // 0x%08" PRIx64 ": %s\n", addr, text);
+        switch (instruction.instructionType) {
+            case isDPI:
+                emitDPI(out, instruction.dpi);
+                break;
+            case isDPR:
+                emitDPR(out, instruction.dpr);
+                break;
+            case isSDT:
+                emitSDT(out, instruction.sdt, addr);
+                break;
+            case isB:
+                emitB(out, instruction.b, addr);
+                fprintf(out, "}\n\n");
+                return;
+        }
+    }
+    uint32_t word = wordAt(addr);
+    if (addr < MEMORY_SIZE && word != HALT_INSTR && !leaders[addr / INSTR_BYTES]) {
+        fprintf(out, "    raiseError(EMULATE_ERROR_UNDEFINED, \"Undefined instruction.\");\n");
+    } else {
+        fprintf(out, "    return 0x%" PRIx64 "u;\n", addr);
+    }
+    fprintf(out, "}\n\n");
+}
+
+// The bitmap of the translated words and the check every store makes against it
+static void emitCheckStore(FILE *out)
+{
+    size_t codeWords = 0;
+    for (size_t i = 0; i < NUM_WORDS; i++) {
+        if (code[i]) {
+            codeWords = i + 1;
+        }
+    }
+    fprintf(out, "#define CODE_WORDS %zu\n\nstatic const uint8_t code[] = {", codeWords);
+    for (size_t i = 0; i < codeWords; i += BYTE_SIZE) {
+        uint8_t bits = 0;
+        for (int j = 0; j < BYTE_SIZE && i + j < codeWords; j++) {
+            bits |= code[i + j] << j;
+        }
+        fprintf(out, "%s0x%02x,", (i / BYTE_SIZE % BYTES_PER_LINE == 0) ? "\n    " : " ", bits);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "// Stop before a store changes translated code, which would have to be translated again\n");
+    fprintf(out, "static void checkStore(uint64_t addr, int bytes)\n{\n");
+    fprintf(out, "    for (uint64_t word = addr / INSTR_BYTES; word <= (addr + bytes - 1) / INSTR_BYTES; word++) {\n");
+    fprintf(out, "        if (word < CODE_WORDS && (code[word / BYTE_SIZE] >> (word %% BYTE_SIZE) & 1)) {\n");
+    fprintf(out, "            raiseError(EMULATE_ERROR_UNSUPPORTED, \"A translated program cannot overwrite its code.\");\n");
+    fprintf(out, "        }\n    }\n}\n\n");
+}
+
+static void emitProgram(FILE *out)
+{
+    fprintf(out, "// Translated by aot-translate, build with: cc -O2 -I src <this file> src/libemulate.a -pthread\n\n");
+    fprintf(out, "#include <stdbool.h>\n#include <stdint.h>\n#include <stdio.h>\n#include <stdlib.h>\n");
+    fprintf(out, "#include \"constants.h\"\n#include \"datatypes_em.h\"\n#include \"execute.h\"\n");
+    fprintf(out, "#include \"libemulate.h\"\n#include \"memory.h\"\n#include \"status.h\"\n\n");
+
+    fprintf(out, "static const uint8_t program[] = {");
+    for (size_t i = 0; i < programSize; i++) {
+        fprintf(out, "%s0x%02x,", (i % BYTES_PER_LINE == 0) ? "\n    " : " ", program[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static struct EmulatorState *s;\n\n");
+    if (hasStores) {
+        emitCheckStore(out);
+    }
+
+    for (size_t i = 0; i < NUM_WORDS; i++) {
+        if (leaders[i] && !halts[i]) {
+            emitBlock(out, i * INSTR_BYTES);
+        }
+    }
+
+    fprintf(out, "// Run blocks from pc until the halt instruction\nstatic void run(uint64_t pc)\n{\n");
+    fprintf(out, "    while (true) {\n        switch (pc) {\n");
+    for (size_t i = 0; i < NUM_WORDS; i++) {
+        if (halts[i]) {
+            fprintf(out, "            case 0x%zxu: s->PC = pc; return;\n", i * INSTR_BYTES);
+        } else if (leaders[i]) {
+            fprintf(out, "            case 0x%zxu: pc = block_%08zx(); break;\n", i * INSTR_BYTES, i * INSTR_BYTES);
+        }
+    }
+    fprintf(out, "            default:\n                s->PC = pc;\n");
+    fprintf(out, "                raiseError(EMULATE_ERROR_UNSUPPORTED, \"Branch to an address that was not translated.\");\n");
+    fprintf(out, "        }\n    }\n}\n\n");
+
+    fprintf(out, "int main(int argc, char **argv)\n{\n");
+    fprintf(out, "    EmulatorOptions options = { .decodeCache = true };\n");
+    fprintf(out, "    Emulator *emulator = emulatorCreate(&options);\n");
+    fprintf(out, "    if (emulator == NULL || emulatorLoad(emulator, program, sizeof(program)) != EMULATE_OK) {\n");
+    fprintf(out, "        fprintf(stderr, \"Failed to load the program.\\n\");\n        return EXIT_FAILURE;\n    }\n");
+    fprintf(out, "    s = emulatorEnter(emulator);\n    run(0);\n\n");
+    fprintf(out, "    FILE *output = (argc > 1) ? fopen(argv[1], \"w\") : stdout;\n");
+    fprintf(out, "    if (output == NULL) {\n        perror(\"Could not open output file.\");\n        return EXIT_FAILURE;\n    }\n");
+    fprintf(out, "    emulatorWriteState(emulator, output);\n");
+    fprintf(out, "    if (output != stdout) {\n        fclose(output);\n    }\n");
+    fprintf(out, "    emulatorDestroy(emulator);\n    return EXIT_SUCCESS;\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        EXIT_PROGRAM("Provide a binary and the C file to translate it to.");
+    }
+    FILE *input = loadInputFile(argv[1], NULL, "rb");
+    uint8_t *data = readWholeFile(input, &programSize);
+    fclose(input);
+    if (data == NULL || programSize == 0) {
+        EXIT_PROGRAM("Could not read the binary.");
+    }
+    program = data;
+
+    addLeader(0);
+    while (pending > 0) {
+        explore(worklist[--pending]);
+    }
+
+    FILE *output = openOutputFile(argv[2], "c", "w");
+    emitProgram(output);
+    if (output != stdout) {
+        fclose(output);
+    }
+    free(data);
+    return EXIT_SUCCESS;
+}
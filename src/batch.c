@@ -0,0 +1,314 @@
+#include <dirent.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "constants.h"
+#include "io.h"
+#include "libemulate.h"
+
+#define MAX_THREADS 64
+#define MAX_PATH_LENGTH 4096
+
+// 64-bit FNV-1a
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+
+// A binary to emulate and the text written for it once done
+typedef struct {
+    char *path;
+    char *result;
+    size_t length;
+    bool done;
+} Job;
+
+// Jobs [head, tail) queued on a worker; the owner takes from the head, thieves from the tail
+typedef struct {
+    pthread_mutex_t lock;
+    int head;
+    int tail;
+} JobQueue;
+
+static Job *jobs = NULL;
+static int numJobs = 0;
+static int capacity = 0;
+
+static JobQueue queues[MAX_THREADS];
+static int numThreads = 0;
+
+// Signalled whenever a job is done, the results being written in manifest order
+static pthread_mutex_t doneLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+
+// Command line options
+static EmulatorOptions options = { .decodeCache = true, .blockCache = true, .jit = false };
+static bool digestOnly = false; // write a digest of each final state instead of the state itself
+static uint64_t budget = EMULATOR_UNLIMITED; // instructions each binary may run
+
+//
+// Job List
+//
+static void addJob(const char *path)
+{
+    if (numJobs == capacity) {
+        capacity = (capacity == 0) ? 64 : 2 * capacity;
+        jobs = realloc(jobs, capacity * sizeof(Job));
+        if (jobs == NULL) {
+            EXIT_PROGRAM("Failed to allocate the job list.");
+        }
+    }
+    Job *job = &jobs[numJobs++];
+    job->path = strdup(path);
+    job->result = NULL;
+    job->length = 0;
+    job->done = false;
+    if (job->path == NULL) {
+        EXIT_PROGRAM("Failed to allocate the job list.");
+    }
+}
+
+// One binary per line, skipping blank lines and # comments
+static void readManifest(const char *manifest)
+{
+    FILE *file = loadInputFile(manifest, NULL, "r");
+    char line[MAX_PATH_LENGTH];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#') {
+            addJob(line);
+        }
+    }
+    fclose(file);
+}
+
+static int comparePaths(const void *a, const void *b)
+{
+    return strcmp(((const Job *)a)->path, ((const Job *)b)->path);
+}
+
+// Every regular file of the directory, in name order
+static void readDirectory(const char *directory)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL) {
+        EXIT_PROGRAM("Could not open the directory.");
+    }
+    struct dirent *entry;
+    char path[MAX_PATH_LENGTH];
+    while ((entry = readdir(dir)) != NULL) {
+        struct stat info;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (entry->d_name[0] != '.' && stat(path, &info) == 0 && S_ISREG(info.st_mode)) {
+            addJob(path);
+        }
+    }
+    closedir(dir);
+    qsort(jobs, numJobs, sizeof(Job), comparePaths);
+}
+
+//
+// Workers
+//
+// Next job for worker self, taken from its own queue or else stolen from another, -1 once all are taken
+static int takeJob(int self)
+{
+    for (int i = 0; i < numThreads; i++) {
+        JobQueue *queue = &queues[(self + i) % numThreads];
+        int job = -1;
+        pthread_mutex_lock(&queue->lock);
+        if (queue->head < queue->tail) {
+            job = (i == 0) ? queue->head++ : --queue->tail;
+        }
+        pthread_mutex_unlock(&queue->lock);
+        if (job >= 0) {
+            return job;
+        }
+    }
+    return -1;
+}
+
+static uint64_t digest(const char *text, size_t length)
+{
+    uint64_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)text[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// Load and run the binary of the job, writing its result to file
+static void runJob(Emulator *emulator, const Job *job, FILE *file)
+{
+    const char *error = NULL;
+    FILE *input = fopen(job->path, "rb");
+    size_t size = 0;
+    uint8_t *program = (input != NULL) ? readWholeFile(input, &size) : NULL;
+    if (input != NULL) {
+        fclose(input);
+    }
+
+    if (program == NULL) {
+        error = "Could not read the binary.";
+    } else if (emulatorLoad(emulator, program, size) != EMULATE_OK) {
+        error = emulatorErrorMessage(emulator);
+    } else {
+        EmulateStatus status = emulatorRun(emulator, budget);
+        if (status == EMULATE_BUDGET_EXHAUSTED) {
+            error = "Instruction budget exhausted.";
+        } else if (status != EMULATE_OK) {
+            error = emulatorErrorMessage(emulator);
+        }
+    }
+    free(program);
+
+    if (error != NULL) {
+        fprintf(file, digestOnly ? "%s: %s\n" : "==> %s <==\n%s\n", job->path, error);
+    } else if (digestOnly) {
+        char *state;
+        size_t length;
+        FILE *stateFile = open_memstream(&state, &length);
+        if (stateFile == NULL) {
+            EXIT_PROGRAM("Failed to capture the final state.");
+        }
+        emulatorWriteState(emulator, stateFile);
+        fclose(stateFile);
+        fprintf(file, "%016" PRIx64 "  %s\n", digest(state, length), job->path);
+        free(state);
+    } else {
+        fprintf(file, "==> %s <==\n", job->path);
+        emulatorWriteState(emulator, file);
+    }
+}
+
+// Run jobs until none are left, reusing one emulator for all of them
+static void *worker(void *argument)
+{
+    int self = (int)(intptr_t)argument;
+    Emulator *emulator = emulatorCreate(&options);
+    if (emulator == NULL) {
+        EXIT_PROGRAM("Failed to create the emulator.");
+    }
+
+    int index;
+    while ((index = takeJob(self)) >= 0) {
+        Job *job = &jobs[index];
+        char *result;
+        size_t length;
+        FILE *file = open_memstream(&result, &length);
+        if (file == NULL) {
+            EXIT_PROGRAM("Failed to capture the final state.");
+        }
+        runJob(emulator, job, file);
+        fclose(file);
+
+        pthread_mutex_lock(&doneLock);
+        job->result = result;
+        job->length = length;
+        job->done = true;
+        pthread_cond_broadcast(&doneCond);
+        pthread_mutex_unlock(&doneLock);
+    }
+    emulatorDestroy(emulator);
+    return NULL;
+}
+
+// Write the results in manifest order as soon as each becomes available
+static void writeResults(FILE *output)
+{
+    for (int i = 0; i < numJobs; i++) {
+        pthread_mutex_lock(&doneLock);
+        while (!jobs[i].done) {
+            pthread_cond_wait(&doneCond, &doneLock);
+        }
+        pthread_mutex_unlock(&doneLock);
+        fwrite(jobs[i].result, 1, jobs[i].length, output);
+        free(jobs[i].result);
+        free(jobs[i].path);
+    }
+}
+
+//
+// Command Line
+//
+// Consume the --options, leaving the positional arguments at the start of argv
+static int parseOptions(int argc, char **argv)
+{
+    int positional = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            argv[positional++] = argv[i];
+        } else if (!strcmp(argv[i], "--no-decode-cache")) {
+            options.decodeCache = false;
+        } else if (!strcmp(argv[i], "--no-block-cache")) {
+            options.blockCache = false;
+        } else if (!strcmp(argv[i], "--jit")) {
+            options.jit = true;
+        } else if (!strcmp(argv[i], "--digest")) {
+            digestOnly = true;
+        } else if (!strncmp(argv[i], "--threads=", strlen("--threads="))) {
+            numThreads = atoi(argv[i] + strlen("--threads="));
+        } else if (!strncmp(argv[i], "--budget=", strlen("--budget="))) {
+            budget = strtoull(argv[i] + strlen("--budget="), NULL, 10);
+        } else {
+            fprintf(stderr, "Unsupported option: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return positional;
+}
+
+//
+// Main Program
+//
+int main(int argc, char **argv)
+{
+    argc = parseOptions(argc, argv);
+    if (argc < 2) {
+        EXIT_PROGRAM("Provide a manifest of binaries or a directory.");
+    }
+    char *outputFile = (argc > 2) ? argv[2] : STDOUT;
+
+    struct stat info;
+    if (stat(argv[1], &info) == 0 && S_ISDIR(info.st_mode)) {
+        readDirectory(argv[1]);
+    } else {
+        readManifest(argv[1]);
+    }
+
+    // One worker per processor by default, each starting with an even share of the jobs
+    if (numThreads <= 0) {
+        numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    numThreads = (numThreads > MAX_THREADS) ? MAX_THREADS : numThreads;
+    numThreads = (numThreads > numJobs) ? numJobs : numThreads;
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < numThreads; i++) {
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].head = (int64_t)numJobs * i / numThreads;
+        queues[i].tail = (int64_t)numJobs * (i + 1) / numThreads;
+    }
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i) != 0) {
+            EXIT_PROGRAM("Failed to start a worker thread.");
+        }
+    }
+
+    FILE *output = openOutputFile(outputFile, NULL, "w");
+    writeResults(output);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    checkErrorOutput(output);
+    if (output != stdout) {
+        fclose(output);
+    }
+    free(jobs);
+
+    return EXIT_SUCCESS;
+}
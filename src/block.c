@@ -0,0 +1,308 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "block.h"
+#include "cache.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "dispatch.h"
+#include "execute.h"
+#include "io.h"
+#include "jit.h"
+#include "profile.h"
+#include "sample.h"
+#include "status.h"
+
+#define NUM_BLOCK_ENTRIES (MEMORY_SIZE / INSTR_BYTES)
+#define RETURN_STACK_DEPTH 16 // calls deeper than this overwrite the oldest return address
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Translated blocks of one emulator
+struct BlockCache {
+    Block *map[NUM_BLOCK_ENTRIES]; // indexed by the address of the first instruction
+    Block *all;
+    struct {
+        uint32_t address; // return address of the call
+        Block **link;     // fallthrough link of the block that made the call
+    } returns[RETURN_STACK_DEPTH];
+    int returnTop;    // entry of the innermost call
+    int returnDepth;  // calls on the return stack
+};
+
+// Whether the block only counts a register down to zero: subs rN, rN, #k then b.ne back to the subs,
+// or sub rN, rN, #k then cbnz rN back to the sub
+static bool isDelayLoop(const Block *block)
+{
+    if (block->length != 2 || block->instructions[0].instructionType != isDPI
+        || block->instructions[1].instructionType != isB) {
+        return false;
+    }
+    const struct DPI *dpi = &block->instructions[0].dpi;
+    const struct B *b = &block->instructions[1].b;
+    if (dpi->opi != ARITHMETIC || dpi->rd != dpi->rn || dpi->rd == ZR_SP || dpi->imm12 == 0) {
+        return false;
+    }
+    if (dpi->opc == SUB_SETFLAGS) {
+        return b->type == BRANCH_CONDITIONAL && b->cond.tag == EQ_NE_TAG && b->cond.neg && b->simm19 == -1;
+    }
+    return dpi->opc == SUB && b->type == BRANCH_COMPARE && b->nonzero && b->rt == dpi->rd && b->sf == dpi->sf
+        && b->simm == -1;
+}
+
+// Translate the straight-line run of instructions starting at start
+static Block *buildBlock(uint32_t start)
+{
+    Instruction instructions[MAX_BLOCK_LENGTH];
+    uint8_t handlers[MAX_BLOCK_LENGTH];
+    int length = 0;
+    bool halts = false;
+
+    uint32_t addr = start;
+    while (length < MAX_BLOCK_LENGTH && addr < MEMORY_SIZE) {
+        DecodedInstr *decoded = fetchDecoded(addr);
+        decoded->translated = true;
+        if (decoded->halt) {
+            halts = true;
+            break;
+        }
+        if (decoded->undefined) { // Only raised once execution reaches the word
+            break;
+        }
+        instructions[length] = decoded->instruction;
+        handlers[length++] = decoded->handler;
+        addr += INSTR_BYTES;
+        if (decoded->instruction.instructionType == isB) {
+            break;
+        }
+    }
+
+    Block *block = malloc(sizeof(Block) + length * sizeof(Instruction));
+    if (block == NULL) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate a basic block.");
+    }
+    block->start = start;
+    block->length = length;
+    block->halts = halts;
+    block->taken = NULL;
+    block->fallthrough = NULL;
+    block->next = state->blockCache->all;
+    block->heat = 0;
+    block->runs = 0;
+    block->takenRuns = 0;
+    block->code = NULL;
+    memcpy(block->instructions, instructions, length * sizeof(Instruction));
+    memcpy(block->handlers, handlers, length * sizeof(uint8_t));
+    block->delayLoop = isDelayLoop(block);
+    state->blockCache->all = block;
+    return block;
+}
+
+// Block starting at pc, NULL if the address cannot hold a cached block
+static Block *findBlock(int64_t pc)
+{
+    if (pc < 0 || pc >= MEMORY_SIZE || pc % INSTR_BYTES != 0) {
+        return NULL;
+    }
+    if (state->blockCache == NULL) {
+        state->blockCache = calloc(1, sizeof(struct BlockCache));
+        if (state->blockCache == NULL) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the block cache.");
+        }
+    }
+    Block **entry = &state->blockCache->map[pc / INSTR_BYTES];
+    if (*entry == NULL) {
+        *entry = buildBlock(pc);
+    }
+    return *entry;
+}
+
+// Branch the block ends with, NULL if it ends otherwise
+static const struct B *finalBranch(const Block *block)
+{
+    if (block->length == 0 || block->instructions[block->length - 1].instructionType != isB) {
+        return NULL;
+    }
+    return &block->instructions[block->length - 1].b;
+}
+
+// Follow the link to the successor block, resolving it on first use. A call pushes the link of
+// its return address, so that ret continues at the caller without looking up the block
+static Block *nextBlock(Block *block)
+{
+    struct BlockCache *cache = state->blockCache;
+    uint32_t end = block->start + block->length * INSTR_BYTES;
+    Block **link = &block->fallthrough;
+    if (state->PC != end) {
+        link = &block->taken;
+        block->takenRuns++;
+    }
+    const struct B *b = finalBranch(block);
+    if (b != NULL && (b->type == BRANCH_LINK || (b->type == BRANCH_REGISTER && b->opc == BLR_OPC))) {
+        cache->returnTop = (cache->returnTop + 1) % RETURN_STACK_DEPTH;
+        cache->returns[cache->returnTop].address = end;
+        cache->returns[cache->returnTop].link = &block->fallthrough;
+        if (cache->returnDepth < RETURN_STACK_DEPTH) {
+            cache->returnDepth++;
+        }
+    } else if (b != NULL && b->type == BRANCH_REGISTER && b->opc == RET_OPC && cache->returnDepth > 0) {
+        if (cache->returns[cache->returnTop].address == state->PC) {
+            link = cache->returns[cache->returnTop].link;
+        }
+        cache->returnTop = (cache->returnTop + RETURN_STACK_DEPTH - 1) % RETURN_STACK_DEPTH;
+        cache->returnDepth--;
+    }
+    if (*link == NULL || (*link)->start != state->PC) {
+        *link = findBlock(state->PC);
+    }
+    return *link;
+}
+
+// Run a block through its host code once hot, interpreting it until then
+static void runBlock(Block *block, bool useJit)
+{
+    if (block->code != NULL) {
+        block->code(state);
+        return;
+    }
+    executeHandlers(block->instructions, block->handlers, block->length);
+    if (useJit && ++block->heat == JIT_THRESHOLD && !state->translatedCodeWritten) {
+        block->code = compileBlock(block);
+    }
+}
+
+// Run as many iterations of a delay loop as the limit allows at once, leaving the registers,
+// flags, PC and instruction count as if each had executed; false to run it normally instead
+static bool fastForwardLoop(Block *block, uint64_t limit)
+{
+    const struct DPI *dpi = &block->instructions[0].dpi;
+    uint64_t mask = dpi->sf ? UINT64_MAX : MASK32;
+    uint64_t step = (uint64_t)dpi->imm12 << (dpi->sh * ARITHMETIC_SHIFT);
+    uint64_t counter = state->R[dpi->rd] & mask;
+    // The loop leaves once the subtraction has computed exactly zero; other counts wrap around first
+    if (counter == 0 || counter % step != 0) {
+        return false;
+    }
+    uint64_t iterations = counter / step;
+    uint64_t available = (limit - state->retired) / block->length;
+    if (available < iterations) {
+        iterations = available;
+    }
+    if (iterations == 0) {
+        return false;
+    }
+
+    uint64_t last = counter - (iterations - 1) * step; // counter as the last subs read it
+    state->R[dpi->rd] = last - step;
+    if (dpi->opc == SUB_SETFLAGS) {
+        updateFlagsArithmetic(last, step, dpi->sf, false);
+    }
+    state->PC = (last == step) ? block->start + block->length * INSTR_BYTES : block->start;
+    state->retired += iterations * block->length;
+    // The branch of the last iteration is counted once the successor is followed
+    block->runs += iterations;
+    block->takenRuns += iterations - 1;
+    return true;
+}
+
+// Add the runs counted on the blocks to the profile
+void profileBlocks(void)
+{
+    for (Block *block = (state->blockCache != NULL) ? state->blockCache->all : NULL; block != NULL;
+         block = block->next) {
+        countBlock(block->start, block->length, block->runs, block->takenRuns);
+        block->runs = 0;
+        block->takenRuns = 0;
+    }
+}
+
+// Discard every translated block, e.g. after the guest code was overwritten
+void flushBlocks(void)
+{
+    profileBlocks();
+    struct BlockCache *cache = state->blockCache;
+    while (cache != NULL && cache->all != NULL) {
+        Block *block = cache->all;
+        cache->all = block->next;
+        for (int i = 0; i < block->length + block->halts; i++) {
+            getDecodeSlot(block->start + i * INSTR_BYTES)->translated = false;
+        }
+        cache->map[block->start / INSTR_BYTES] = NULL;
+        free(block);
+    }
+    if (cache != NULL) {
+        cache->returnDepth = 0;
+    }
+    resetJit();
+    state->translatedCodeWritten = false;
+}
+
+void freeBlocks(void)
+{
+    flushBlocks();
+    free(state->blockCache);
+    state->blockCache = NULL;
+}
+
+// Run one instruction outside of any block, true if it is the halt instruction
+static bool stepInstruction(void)
+{
+    DecodedInstr *decoded = fetchDecoded(state->PC);
+    if (decoded->halt) {
+        return true;
+    }
+    if (decoded->undefined) {
+        raiseError(EMULATE_ERROR_UNDEFINED, "Undefined instruction.");
+    }
+    uint64_t pc = state->PC;
+    int executeError = execute(decoded->instruction);
+    checkError(executeError);
+    state->retired++;
+    countInstruction(pc, state->PC);
+    trackBranch(&decoded->instruction);
+    return false;
+}
+
+// Run basic blocks from the current PC until the halt instruction or until limit
+// instructions have retired, true if the program halted
+bool runBlocks(bool useJit, uint64_t limit)
+{
+    Block *block = findBlock(state->PC);
+    while (state->retired < limit) {
+        if (block == NULL || state->retired + block->length > limit) {
+            // Outside the cached memory or about to overrun the limit, step a single instruction
+            if (stepInstruction()) {
+                return true;
+            }
+            block = findBlock(state->PC);
+            continue;
+        }
+        if (block->length == 0 && !block->halts) {
+            raiseError(EMULATE_ERROR_UNDEFINED, "Undefined instruction.");
+        }
+
+        if (!block->delayLoop || !fastForwardLoop(block, limit)) {
+            runBlock(block, useJit);
+            if (state->translatedCodeWritten) {
+                // The block stopped after the store that overwrote translated code
+                countBlock(block->start, (state->PC - block->start) / INSTR_BYTES, 1, 0);
+                flushBlocks();
+                block = findBlock(state->PC);
+                continue;
+            }
+            block->runs++;
+            if (block->length > 0) {
+                trackBranch(&block->instructions[block->length - 1]);
+            }
+        }
+        if (block->halts) {
+            return true;
+        }
+        block = nextBlock(block);
+    }
+    // The limit may fall just before the halt instruction
+    DecodedInstr *decoded = fetchDecoded(state->PC);
+    return decoded->halt;
+}
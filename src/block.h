@@ -0,0 +1,41 @@
+// Basic block translation cache, running straight-line code as one unit
+
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "structs.h"
+
+#define MAX_BLOCK_LENGTH 64
+
+struct EmulatorState;
+
+// Host code translated from a block
+typedef void (*CompiledBlock)(struct EmulatorState *state);
+
+// Basic block: a straight-line run ending at a branch or at the halt instruction
+typedef struct Block Block;
+struct Block {
+    uint32_t start;     // address of the first instruction
+    int length;         // number of instructions, excluding the halt instruction
+    bool halts;         // the block is followed by the halt instruction
+    bool delayLoop;     // the block is a delay loop, run in closed form
+    Block *taken;       // successor once the final branch is taken
+    Block *fallthrough; // successor when the block falls through
+    Block *next;        // list of all translated blocks
+    int heat;           // executions so far while interpreted
+    uint64_t runs;      // complete runs not yet added to the profile
+    uint64_t takenRuns; // runs that left through the final branch
+    CompiledBlock code; // host code once the block is hot, NULL until then
+    uint8_t handlers[MAX_BLOCK_LENGTH]; // dispatch handler of each instruction
+    Instruction instructions[];
+};
+
+// Prototypes
+extern bool runBlocks(bool useJit, uint64_t limit);
+extern void flushBlocks(void);
+extern void freeBlocks(void);
+extern void profileBlocks(void);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "decoders.h"
+#include "dispatch.h"
+#include "io.h"
+#include "memory.h"
+#include "status.h"
+#include "utils_em.h"
+
+#define NUM_SLOTS (MEMORY_SIZE / INSTR_BYTES)
+#define CHUNK_SLOTS 1024
+#define NUM_CHUNKS (NUM_SLOTS / CHUNK_SLOTS)
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// One slot per instruction word of the memory, allocated a chunk at a time on first use
+struct DecodeCache {
+    DecodedInstr *chunks[NUM_CHUNKS];
+    DecodedInstr uncached; // scratch slot for addresses outside the cache
+};
+
+// Cache of the current emulator, allocated on first use
+static struct DecodeCache *getCache(void)
+{
+    if (state->decodeCache == NULL) {
+        state->decodeCache = calloc(1, sizeof(struct DecodeCache));
+        if (state->decodeCache == NULL) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the decode cache.");
+        }
+    }
+    return state->decodeCache;
+}
+
+// Fetch instruction from memory
+uint32_t fetch(uint64_t addr)
+{
+    return readMemory(addr, INSTR_BYTES);
+}
+
+// Slot for the word at addr, NULL if the address cannot hold a cached instruction
+DecodedInstr *getDecodeSlot(uint64_t addr)
+{
+    if (addr >= MEMORY_SIZE || addr % INSTR_BYTES != 0) {
+        return NULL;
+    }
+    struct DecodeCache *cache = getCache();
+    uint64_t index = addr / INSTR_BYTES;
+    DecodedInstr **chunk = &cache->chunks[index / CHUNK_SLOTS];
+    if (*chunk == NULL) {
+        *chunk = calloc(CHUNK_SLOTS, sizeof(DecodedInstr));
+        if (*chunk == NULL) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the decode cache.");
+        }
+    }
+    return &(*chunk)[index % CHUNK_SLOTS];
+}
+
+// Fetch and decode through the predecode cache, filling the slot on first use
+DecodedInstr *fetchDecoded(uint64_t addr)
+{
+    DecodedInstr *slot = getDecodeSlot(addr);
+    if (slot == NULL) {
+        slot = &getCache()->uncached;
+        slot->valid = false;
+    }
+    if (!slot->valid) {
+        uint32_t instr = fetch(addr);
+        slot->halt = (instr == HALT_INSTR);
+        slot->undefined = !slot->halt && !isDecodable(instr);
+        if (!slot->halt && !slot->undefined) {
+            int decodeError = decode(&instr, &slot->instruction, getBits);
+            checkError(decodeError);
+            slot->handler = selectHandler(&slot->instruction);
+        }
+        slot->valid = true;
+    }
+    return slot;
+}
+
+// Drop the slots of every word overlapping the bytes [addr, addr + bytes)
+void invalidateDecodeCache(uint64_t addr, int bytes)
+{
+    uint64_t first = addr / INSTR_BYTES;
+    uint64_t last = (addr + bytes - 1) / INSTR_BYTES;
+    struct DecodeCache *cache = state->decodeCache;
+    for (uint64_t i = first; cache != NULL && i <= last && i < NUM_SLOTS; i++) {
+        DecodedInstr *chunk = cache->chunks[i / CHUNK_SLOTS];
+        if (chunk != NULL) {
+            chunk[i % CHUNK_SLOTS].valid = false;
+            state->translatedCodeWritten |= chunk[i % CHUNK_SLOTS].translated;
+        }
+    }
+}
+
+// Drop every slot, e.g. before another program is loaded; only chunks in use are cleared
+void clearDecodeCache(void)
+{
+    struct DecodeCache *cache = state->decodeCache;
+    for (int i = 0; cache != NULL && i < NUM_CHUNKS; i++) {
+        if (cache->chunks[i] != NULL) {
+            memset(cache->chunks[i], 0, CHUNK_SLOTS * sizeof(DecodedInstr));
+        }
+    }
+}
+
+void freeDecodeCache(void)
+{
+    struct DecodeCache *cache = state->decodeCache;
+    for (int i = 0; cache != NULL && i < NUM_CHUNKS; i++) {
+        free(cache->chunks[i]);
+    }
+    free(cache);
+    state->decodeCache = NULL;
+}
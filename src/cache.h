@@ -0,0 +1,29 @@
+// Predecode cache holding the decoded form of every instruction word in memory
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "structs.h"
+
+
+// Decoded instruction slot, one per 4-byte word of memory
+typedef struct {
+    bool valid;      // slot holds the decoded form of the word
+    bool halt;       // word is the halt instruction
+    bool undefined;  // word does not decode to an instruction
+    bool translated; // word is part of a basic block
+    uint8_t handler; // handler specialised for the decoded form
+    Instruction instruction;
+} DecodedInstr;
+
+// Prototypes
+extern uint32_t fetch(uint64_t addr);
+extern DecodedInstr *getDecodeSlot(uint64_t addr);
+extern DecodedInstr *fetchDecoded(uint64_t addr);
+extern void invalidateDecodeCache(uint64_t addr, int bytes);
+extern void clearDecodeCache(void);
+extern void freeDecodeCache(void);
+
+#endif
@@ -0,0 +1,200 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "execute.h"
+#include "memory.h"
+#include "status.h"
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Contents of a page before its first write after a checkpoint
+typedef struct SavedPage SavedPage;
+struct SavedPage {
+    uint64_t addr;
+    SavedPage *next;
+    uint8_t data[PAGE_SIZE];
+};
+
+// Registers and flags at a checkpoint, and the pages written since, so that undoing the
+// pages of every later checkpoint and then its own returns memory to this point
+typedef struct {
+    uint64_t retired;
+    int64_t R[NUM_OF_REGISTERS];
+    int64_t ZR;
+    int64_t PC;
+    int64_t SP;
+    struct PSTATE pstate;
+    SavedPage *pages;
+} Checkpoint;
+
+// Checkpoints oldest first, the oldest dropped once the saved pages outgrow the budget
+struct Checkpoints {
+    Checkpoint *list;
+    int count;
+    int capacity;
+    uint64_t interval; // instructions between checkpoints
+    size_t budget;     // bytes of saved pages
+    size_t used;
+};
+
+bool initializeCheckpoints(uint64_t interval, size_t budget)
+{
+    struct Checkpoints *checkpoints = calloc(1, sizeof(struct Checkpoints));
+    if (checkpoints == NULL) {
+        return false;
+    }
+    checkpoints->interval = interval;
+    checkpoints->budget = budget;
+    state->checkpoints = checkpoints;
+    return true;
+}
+
+// Retired count at which the next checkpoint is due, UINT64_MAX if none are taken
+uint64_t nextCheckpoint(void)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    if (checkpoints == NULL) {
+        return UINT64_MAX;
+    }
+    if (checkpoints->count == 0) {
+        return state->retired;
+    }
+    uint64_t last = checkpoints->list[checkpoints->count - 1].retired;
+    return (last / checkpoints->interval + 1) * checkpoints->interval;
+}
+
+static void freePages(Checkpoint *checkpoint)
+{
+    while (checkpoint->pages != NULL) {
+        SavedPage *page = checkpoint->pages;
+        checkpoint->pages = page->next;
+        free(page);
+        state->checkpoints->used -= sizeof(SavedPage);
+    }
+}
+
+// Forget the oldest checkpoints until the saved pages fit the budget, keeping the newest
+static void dropOldest(void)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    int dropped = 0;
+    while (checkpoints->used > checkpoints->budget && dropped < checkpoints->count - 1) {
+        freePages(&checkpoints->list[dropped++]);
+    }
+    if (dropped > 0) {
+        checkpoints->count -= dropped;
+        memmove(checkpoints->list, checkpoints->list + dropped, checkpoints->count * sizeof(Checkpoint));
+    }
+}
+
+// Save the page into the newest checkpoint before it is first written to
+static void savePage(uint64_t addr, const uint8_t *contents, void *context)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    SavedPage *page = malloc(sizeof(SavedPage));
+    if (page == NULL) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate a checkpoint page.");
+    }
+    page->addr = addr;
+    memcpy(page->data, contents, PAGE_SIZE);
+    Checkpoint *newest = &checkpoints->list[checkpoints->count - 1];
+    page->next = newest->pages;
+    newest->pages = page;
+    checkpoints->used += sizeof(SavedPage);
+    dropOldest();
+}
+
+// Checkpoint the current state, every page being saved on its next write
+void takeCheckpoint(void)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    if (checkpoints->count == checkpoints->capacity) {
+        int capacity = (checkpoints->capacity == 0) ? 64 : 2 * checkpoints->capacity;
+        Checkpoint *list = realloc(checkpoints->list, capacity * sizeof(Checkpoint));
+        if (list == NULL) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate a checkpoint.");
+        }
+        checkpoints->list = list;
+        checkpoints->capacity = capacity;
+    }
+    evaluateFlags();
+    Checkpoint *checkpoint = &checkpoints->list[checkpoints->count++];
+    checkpoint->retired = state->retired;
+    memcpy(checkpoint->R, state->R, sizeof(checkpoint->R));
+    checkpoint->ZR = state->ZR;
+    checkpoint->PC = state->PC;
+    checkpoint->SP = state->SP;
+    checkpoint->pstate = state->pstate;
+    checkpoint->pages = NULL;
+    protectPages(savePage, NULL);
+}
+
+// Newest checkpoint taken at or before retired, -1 if every such checkpoint was dropped
+int findCheckpoint(uint64_t retired)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    int index = (checkpoints != NULL) ? checkpoints->count - 1 : -1;
+    while (index >= 0 && checkpoints->list[index].retired > retired) {
+        index--;
+    }
+    return index;
+}
+
+uint64_t checkpointRetired(int index)
+{
+    return state->checkpoints->list[index].retired;
+}
+
+// Return to the state of the checkpoint, forgetting every later one
+void restoreCheckpoint(int index)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    protectPages(NULL, NULL);
+    for (int i = checkpoints->count - 1; i >= index; i--) {
+        for (SavedPage *page = checkpoints->list[i].pages; page != NULL; page = page->next) {
+            copyToMemory(page->addr, page->data, PAGE_SIZE);
+        }
+        freePages(&checkpoints->list[i]);
+    }
+    checkpoints->count = index + 1;
+
+    Checkpoint *checkpoint = &checkpoints->list[index];
+    state->retired = checkpoint->retired;
+    memcpy(state->R, checkpoint->R, sizeof(checkpoint->R));
+    state->ZR = checkpoint->ZR;
+    state->PC = checkpoint->PC;
+    state->SP = checkpoint->SP;
+    state->pstate = checkpoint->pstate;
+    state->flagOp.kind = FLAGS_EVALUATED;
+    protectPages(savePage, NULL);
+}
+
+// Forget every checkpoint, e.g. before another program is loaded
+void clearCheckpoints(void)
+{
+    struct Checkpoints *checkpoints = state->checkpoints;
+    if (checkpoints == NULL) {
+        return;
+    }
+    for (int i = 0; i < checkpoints->count; i++) {
+        freePages(&checkpoints->list[i]);
+    }
+    checkpoints->count = 0;
+    protectPages(NULL, NULL);
+}
+
+void freeCheckpoints(void)
+{
+    if (state->checkpoints == NULL) {
+        return;
+    }
+    clearCheckpoints();
+    free(state->checkpoints->list);
+    free(state->checkpoints);
+    state->checkpoints = NULL;
+}
@@ -0,0 +1,21 @@
+// Periodic copy-on-write checkpoints of an emulator, for running backwards
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Prototypes
+extern bool initializeCheckpoints(uint64_t interval, size_t budget);
+extern uint64_t nextCheckpoint(void);
+extern void takeCheckpoint(void);
+extern int findCheckpoint(uint64_t retired);
+extern uint64_t checkpointRetired(int index);
+extern void restoreCheckpoint(int index);
+extern void clearCheckpoints(void);
+extern void freeCheckpoints(void);
+
+#endif
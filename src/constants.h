@@ -11,7 +11,7 @@
 #define INSTR_BYTES 4
 #define ZR_SP 31
 #define NUM_OF_REGISTERS 31
-#define MEMORY_SIZE (2 * 1024 * 1024) // 2MB
+#define MEMORY_SIZE (2 * 1024 * 1024) // 2MB, the region covered by the instruction caches
 
 #define XZR "xzr"
 #define WZR "wzr"
@@ -53,15 +53,32 @@
 
 #define BRANCH_UNCONDITIONAL 0 // 00
 #define BRANCH_CONDITIONAL 1 // 01
+#define BRANCH_LINK 2 // 10
 #define BRANCH_REGISTER 3 // 11
+#define BRANCH_COMPARE 4 // cbz, cbnz: bit 29 set rather than a type in bits 30-31
+#define BRANCH_TEST 5    // tbz, tbnz: bits 29 and 25 set
+
+#define BR_OPC 0 // 0000
+#define BLR_OPC 1 // 0001
+#define RET_OPC 2 // 0010
+#define LINK_REGISTER 30 // x30 holds the return address of the current function
 
 #define DPR_OPC 0 // 00
 #define DPR_MUL 8 // 1000
+#define DPR_SELECT 4 // 0100
+#define SELECT_INVERT 2 // opc of csinv and csneg
+#define SELECT_INCREMENT 1 // op2 of csinc and csneg
+#define DPR_DIVIDE 6 // 0110
+#define UDIV_OPCODE 2 // 000010
+#define SDIV_OPCODE 3 // 000011
 #define SDT_IMM12_32 4
 #define SDT_IMM12_64 8
 #define SDT_ROFF1 3 // 11
 #define SDT_ROFF2 2 // 10
 #define SDT_BIT 1 // 1
+#define PAIR_POST_INDEX 1 // 01
+#define PAIR_OFFSET 2 // 10
+#define PAIR_PRE_INDEX 3 // 11
 #define B_BIT 1 // 1
 #define B_REG 31 // 11111
 
@@ -73,19 +90,9 @@
 #define N_MOD 2
 
 #define EQ_NE_TAG 0
-#define EQ_NEG 0
-#define NE_NEG 1
-
 #define GE_LT_TAG 5
-#define GE_NEG 0
-#define LT_NEG 1
-
 #define GT_LE_TAG 6
-#define GT_NEG 0
-#define LE_NEG 1
-
 #define ALWAYS_TAG 7
-#define ALWAYS_NEG 0
 
 #define CMP 0
 #define CMN 1
@@ -96,5 +103,10 @@
 #define MOV 6
 #define MUL 7
 #define MNEG 8
+#define CSET 9
+#define CSETM 10
+#define CINC 11
+#define CINV 12
+#define CNEG 13
 
 #endif
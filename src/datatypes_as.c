@@ -6,23 +6,27 @@ const char *dataProcessing[] = {
     "add", "adds", "sub", "subs",
     "and", "ands", "bic", "bics", "eor", "orr", "eon", "orn",
     "movk", "movn", "movz",
-    "madd", "msub"
+    "madd", "msub",
+    "csel", "csinc", "csinv", "csneg",
+    "udiv", "sdiv"
 };
 
 const char *loadAndStore[] = {
-    "str", "ldr"
+    "str", "ldr", "stp", "ldp"
 };
 
 const char *branching[] = {
-    "b", "br", "b.eq", "b.ne", "b.ge", "b.lt", "b.gt", "b.le", "b.al"
+    "b", "bl", "br", "blr", "ret", "cbz", "cbnz", "tbz", "tbnz", "b.eq", "b.ne", "b.ge", "b.lt", "b.gt", "b.le", "b.al"
 };
 
 const char *aliases[] = {
-    "cmp", "cmn", "neg", "negs", "tst", "mvn", "mov", "mul", "mneg"
+    "cmp", "cmn", "neg", "negs", "tst", "mvn", "mov", "mul", "mneg",
+    "cset", "csetm", "cinc", "cinv", "cneg"
 };
 
 const char *aliasesName[] = {
-    "subs", "adds", "sub", "subs", "ands", "orn", "orr", "madd", "msub"
+    "subs", "adds", "sub", "subs", "ands", "orn", "orr", "madd", "msub",
+    "csinc", "csinv", "csinc", "csinv", "csneg"
 };
 
 const char *directive[] = {
@@ -48,3 +52,16 @@ const char *wideMoves[] = {
 const char *multiply[] = {
     "madd", "msub"
 };
+
+const char *conditionalSelect[] = {
+    "csel", "csinc", "csinv", "csneg"
+};
+
+const char *divide[] = {
+    "udiv", "sdiv"
+};
+
+// Each condition is followed by its inverse
+const char *conditions[] = {
+    "eq", "ne", "ge", "lt", "gt", "le", "al", "nv"
+};
@@ -5,17 +5,20 @@
 
 #include <stdint.h>
 
-#define DATA_PROCESSING_SIZE 17
-#define LOAD_AND_STORE_SIZE 2
-#define BRANCHING_SIZE 9
-#define ALIASES_SIZE 9
-#define ALIASES_NAME_SIZE 9
+#define DATA_PROCESSING_SIZE 23
+#define LOAD_AND_STORE_SIZE 4
+#define BRANCHING_SIZE 16
+#define ALIASES_SIZE 14
+#define ALIASES_NAME_SIZE 14
 #define DIRECTIVE_SIZE 1
 #define SHIFTS_SIZE 4
 #define ARITHMETICS_SIZE 4
 #define LOGICAL_SIZE 8
 #define WIDE_MOVES_SIZE 4
 #define MULTIPLY_SIZE 2
+#define SELECT_SIZE 4
+#define DIVIDE_SIZE 2
+#define CONDITIONS_SIZE 8
 
 #define BUFFER_LENGTH 256
 #define NUM_INSTRS 256
@@ -44,6 +47,9 @@ extern const char *arithmetics[ARITHMETICS_SIZE];
 extern const char *logical[LOGICAL_SIZE];
 extern const char *wideMoves[WIDE_MOVES_SIZE];
 extern const char *multiply[MULTIPLY_SIZE];
+extern const char *conditionalSelect[SELECT_SIZE];
+extern const char *divide[DIVIDE_SIZE];
+extern const char *conditions[CONDITIONS_SIZE];
 
 enum type
 {
@@ -17,19 +17,45 @@
 
 #define HALT_INSTR 0x8a000000LL
 
+// Kinds of flag-setting operation recorded for lazy evaluation
+#define FLAGS_EVALUATED 0 // pstate holds the current flags
+#define FLAGS_ADD 1
+#define FLAGS_SUB 2
+#define FLAGS_AND 3
+
 // Emulator State
 struct EmulatorState {
     int64_t R[NUM_OF_REGISTERS]; // Registers R0-R30
     int64_t ZR; // Zero Register
     int64_t PC; // Program Counter
     int64_t SP; // Stack Pointer
+    uint64_t retired; // Instructions executed so far
     struct PSTATE { // Processor State
         bool N; // Negative flag
         bool Z; // Zero flag
         bool C; // Carry flag
         bool V; // oVerflow flag
     } pstate;
-    uint8_t mem[MEMORY_SIZE]; // Memory
+    struct FlagOp { // Last flag-setting operation, evaluated into pstate on demand
+        uint8_t kind; // FLAGS_EVALUATED once pstate is up to date
+        bool sf;
+        int64_t a;
+        int64_t b;
+        int64_t result;
+    } flagOp;
+    bool translatedCodeWritten; // a store overwrote a word belonging to a basic block
+
+    // Caches and devices of this emulator, private to their modules
+    struct Memory *memory;
+    struct DecodeCache *decodeCache;
+    struct BlockCache *blockCache;
+    struct Jit *jit;
+    struct Devices *devices;
+    struct Profile *profile; // NULL unless profiling
+    struct CallStack *callStack; // NULL unless sampling
+    struct Trace *trace; // NULL unless tracing
+    struct Checkpoints *checkpoints; // NULL unless checkpointing
+    struct Timing *timing; // NULL unless timing
 };
 
 #endif
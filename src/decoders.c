@@ -53,19 +53,56 @@ int decodeDPR(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
         bitFunc(instr, &(dpr->n), DPR_N_OFFSET, DPR_N_LEN);
         bitFunc(instr, &(dpr->operand), DPR_OPERAND_OFFSET, DPR_OPERAND_LEN);
     }
-    else { // Multiply
+    else { // Multiply, Conditional Select, Divide
         bitFunc(instr, &(dpr->opr), DPR_OPR_OFFSET, DPR_OPR_LEN);
-        bitFunc(instr, &(dpr->x), DPR_X_OFFSET, DPR_X_LEN);
-        bitFunc(instr, &(dpr->ra), DPR_RA_OFFSET, DPR_RA_LEN);
+        if (dpr->opr == DPR_DIVIDE) {
+            bitFunc(instr, &(dpr->opcode), DPR_OPCODE_OFFSET, DPR_OPCODE_LEN);
+        } else if (dpr->opr == DPR_SELECT) {
+            bitFunc(instr, &(dpr->cond.tag), DPR_TAG_OFFSET, DPR_TAG_LEN);
+            bitFunc(instr, &(dpr->cond.neg), DPR_NEG_OFFSET, DPR_NEG_LEN);
+            bitFunc(instr, &(dpr->op2), DPR_OP2_OFFSET, DPR_OP2_LEN);
+        } else {
+            bitFunc(instr, &(dpr->x), DPR_X_OFFSET, DPR_X_LEN);
+            bitFunc(instr, &(dpr->ra), DPR_RA_OFFSET, DPR_RA_LEN);
+        }
     }
     return EXIT_SUCCESS;
 }
 
+// Load and store pairs
+static int decodePair(uint32_t *instr, struct SDT *sdt, BitFunc bitFunc)
+{
+    sdt->mode = 1;
+    bitFunc(instr, &(sdt->sf), SDT_PAIR_SF_OFFSET, SDT_PAIR_SF_LEN);
+    bitFunc(instr, &(sdt->mode), SDT_MODE_OFFSET2, SDT_MODE_LEN2);
+    bitFunc(instr, &(sdt->index), SDT_INDEX_OFFSET, SDT_INDEX_LEN);
+    bitFunc(instr, &(sdt->l), SDT_L_OFFSET, SDT_L_LEN);
+
+    // Only the low byte is read, so start from the encoded bits alone
+    int16_t simm7 = sdt->simm7 & ((1 << SDT_SIMM7_LEN) - 1);
+    bitFunc(instr, &simm7, SDT_SIMM7_OFFSET, SDT_SIMM7_LEN);
+    signExtendTo32Bits(&simm7, SDT_SIMM7_LEN);
+    sdt->simm7 = simm7;
+
+    bitFunc(instr, &(sdt->rt2), SDT_RT2_OFFSET, SDT_RT2_LEN);
+    bitFunc(instr, &(sdt->xn), SDT_XN_OFFSET, SDT_XN_LEN);
+    bitFunc(instr, &(sdt->rt), SDT_RT_OFFSET, SDT_RT_LEN);
+    return EXIT_SUCCESS;
+}
+
 int decodeSDT(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
 {
     instruction->instructionType = isSDT;
     struct SDT *sdt = &(instruction->sdt);
 
+    // Pairs clear bit 28, which the other loads and stores set
+    bool single = !sdt->pair;
+    bitFunc(instr, &single, SDT_SINGLE_OFFSET, SDT_SINGLE_LEN);
+    sdt->pair = !single;
+    if (sdt->pair) {
+        return decodePair(instr, sdt, bitFunc);
+    }
+
     bitFunc(instr, &(sdt->mode), SDT_MODE_OFFSET, SDT_MODE_LEN);
     bitFunc(instr, &(sdt->sf), SDT_SF_OFFSET, SDT_SF_LEN);
     bitFunc(instr, &(sdt->mode), SDT_MODE_OFFSET2, SDT_MODE_LEN2);
@@ -98,16 +135,46 @@ int decodeSDT(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
     return EXIT_SUCCESS;
 }
 
+// Compare and branch, test and branch
+static int decodeCompareB(uint32_t *instr, struct B *b, BitFunc bitFunc)
+{
+    bool test = (b->type == BRANCH_TEST);
+    bitFunc(instr, &test, B_TEST_OFFSET, B_TEST_LEN);
+    b->type = test ? BRANCH_TEST : BRANCH_COMPARE;
+
+    bitFunc(instr, &(b->sf), B_SF_OFFSET, B_SF_LEN);
+    bitFunc(instr, &(b->nonzero), B_NONZERO_OFFSET, B_NONZERO_LEN);
+    bitFunc(instr, &(b->rt), B_RT_OFFSET, B_RT_LEN);
+    if (test) {
+        int16_t simm14 = b->simm;
+        bitFunc(instr, &(b->b40), B_B40_OFFSET, B_B40_LEN);
+        bitFunc(instr, &simm14, B_SIMM14_OFFSET, B_SIMM14_LEN);
+        signExtendTo32Bits(&simm14, B_SIMM14_LEN);
+        b->simm = simm14;
+    } else {
+        bitFunc(instr, &(b->simm), B_SIMM19_OFFSET, B_SIMM19_LEN);
+        signExtendTo32Bits(&(b->simm), B_SIMM19_LEN);
+    }
+    return EXIT_SUCCESS;
+}
+
 int decodeB(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
 {
     instruction->instructionType = isB;
     struct B *b = &(instruction->b);
 
+    // Only compare and test branches set bit 29
+    bool compare = (b->type == BRANCH_COMPARE || b->type == BRANCH_TEST);
+    bitFunc(instr, &compare, B_COMPARE_OFFSET, B_COMPARE_LEN);
+    if (compare) {
+        return decodeCompareB(instr, b, bitFunc);
+    }
     bitFunc(instr, &(b->type), B_TYPE_OFFSET, B_TYPE_LEN);
 
     // Type of branch
     switch (b->type) {
         case BRANCH_UNCONDITIONAL: // Unconditional
+        case BRANCH_LINK: // With link
             bitFunc(instr, &(b->simm26), B_SIMM26_OFFSET, B_SIMM26_LEN);
             signExtendTo32Bits(&(b->simm26), B_SIMM26_LEN);
             break;
@@ -119,11 +186,10 @@ int decodeB(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
             break;
         case BRANCH_REGISTER: // Register
             bitFunc(instr, &(b->bit), B_BIT_OFFSET, B_BIT_LEN);
+            bitFunc(instr, &(b->opc), B_OPC_OFFSET, B_OPC_LEN);
             bitFunc(instr, &(b->reg), B_REG_OFFSET, B_REG_LEN);
             bitFunc(instr, &(b->xn), B_XN_OFFSET, B_XN_LEN);
             break;
-        default:
-            EXIT_PROGRAM("Unsupported branch type (bits 30-31), use either 00, 01 or 11.");
     }
     return EXIT_SUCCESS;
 }
@@ -143,6 +209,40 @@ static int setOp0(Instruction *instruction) {
     }
 }
 
+// Whether decode accepts the word, so that emulators can reject it without exiting
+bool isDecodable(uint32_t instr)
+{
+    uint8_t op0 = (instr >> OP0_OFFSET) & ((1 << OP0_LEN) - 1);
+    if (OP0_IS_DPI(op0)) {
+        uint8_t opi = (instr >> DPI_OPI_OFFSET) & ((1 << DPI_OPI_LEN) - 1);
+        return opi == ARITHMETIC || opi == WIDEMOVE;
+    } else if (OP0_IS_B(op0)) {
+        uint8_t type = (instr >> B_TYPE_OFFSET) & ((1 << B_TYPE_LEN) - 1);
+        uint8_t opc = (instr >> B_OPC_OFFSET) & ((1 << B_OPC_LEN) - 1);
+        if ((instr >> B_COMPARE_OFFSET) & 1) { // Compare and test branches leave bit 30 clear
+            return (type & 1) == 0;
+        }
+        return type != BRANCH_REGISTER || opc <= RET_OPC;
+    } else if (OP0_IS_DPR(op0) && ((instr >> DPR_M_OFFSET) & 1)) {
+        uint8_t opr = (instr >> DPR_OPR_OFFSET) & ((1 << DPR_OPR_LEN) - 1);
+        uint8_t op2 = (instr >> DPR_OP2_OFFSET) & ((1 << DPR_OP2_LEN) - 1);
+        if (opr == DPR_SELECT) { // Conditional selects leave S and bit 11 clear
+            return !((instr >> DPR_OPC_OFFSET) & 1) && op2 <= SELECT_INCREMENT;
+        }
+        if (opr == DPR_DIVIDE) { // Only udiv and sdiv of the two-source operations
+            uint8_t opcode = (instr >> DPR_OPCODE_OFFSET) & ((1 << DPR_OPCODE_LEN) - 1);
+            uint8_t opc = (instr >> DPR_OPC_OFFSET) & ((1 << DPR_OPC_LEN) - 1);
+            return opc == 0 && (opcode == UDIV_OPCODE || opcode == SDIV_OPCODE);
+        }
+        return true;
+    } else if (OP0_IS_SDT(op0) && !((instr >> SDT_SINGLE_OFFSET) & 1)) { // Pairs of general registers
+        uint8_t index = (instr >> SDT_INDEX_OFFSET) & ((1 << SDT_INDEX_LEN) - 1);
+        return ((instr >> SDT_MODE_OFFSET2) & 1) && !((instr >> SDT_SF_OFFSET) & 1)
+               && !((instr >> SDT_VECTOR_OFFSET) & 1) && index != 0;
+    }
+    return OP0_IS_DPR(op0) || OP0_IS_SDT(op0);
+}
+
 // Generic decode function
 int decode(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
 {
@@ -3,6 +3,7 @@
 #ifndef DECODERS_H
 #define DECODERS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "structs.h"
 
@@ -15,6 +16,7 @@ extern int decodeDPI(uint32_t *instr, Instruction *instruction, BitFunc bitFunc)
 extern int decodeDPR(uint32_t *instr, Instruction *instruction, BitFunc bitFunc);
 extern int decodeSDT(uint32_t *instr, Instruction *instruction, BitFunc bitFunc);
 extern int decodeB(uint32_t *instr, Instruction *instruction, BitFunc bitFunc);
+extern bool isDecodable(uint32_t instr);
 extern int decode(uint32_t *instr, Instruction *instruction, BitFunc bitFunc);
 
 #endif
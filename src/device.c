@@ -0,0 +1,85 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "device.h"
+#include "memory.h"
+#include "status.h"
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Devices mapped into the address space of one emulator
+struct Devices {
+    Device list[MAX_DEVICES];
+    int count;
+};
+
+// Map a device over its address range, taking precedence over RAM
+void registerDevice(const Device *device)
+{
+    struct Devices *devices = state->devices;
+    if (devices == NULL) {
+        devices = state->devices = calloc(1, sizeof(struct Devices));
+        if (devices == NULL) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the device list.");
+        }
+    }
+    if (devices->count == MAX_DEVICES) {
+        raiseError(EMULATE_ERROR_DEVICE, "Too many memory-mapped devices.");
+    }
+    devices->list[devices->count++] = *device;
+    // Pages now covered by the device must not be reached through the TLB
+    flushTLB();
+}
+
+// Device whose range holds addr, NULL for plain memory
+const Device *findDevice(uint64_t addr)
+{
+    struct Devices *devices = state->devices;
+    for (int i = 0; devices != NULL && i < devices->count; i++) {
+        if (addr - devices->list[i].base < devices->list[i].size) {
+            return &devices->list[i];
+        }
+    }
+    return NULL;
+}
+
+// Whether any device overlaps the page, whose accesses then bypass the TLB
+bool deviceInPage(uint64_t pageBase, uint64_t pageSize)
+{
+    struct Devices *devices = state->devices;
+    for (int i = 0; devices != NULL && i < devices->count; i++) {
+        const Device *device = &devices->list[i];
+        if (device->base < pageBase + pageSize && pageBase < device->base + device->size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Return every device to its power-on state
+void resetDevices(void)
+{
+    struct Devices *devices = state->devices;
+    for (int i = 0; devices != NULL && i < devices->count; i++) {
+        if (devices->list[i].reset != NULL) {
+            devices->list[i].reset(devices->list[i].context);
+        }
+    }
+}
+
+// Unmap every device, releasing their state
+void freeDevices(void)
+{
+    struct Devices *devices = state->devices;
+    for (int i = 0; devices != NULL && i < devices->count; i++) {
+        if (devices->list[i].release != NULL) {
+            devices->list[i].release(devices->list[i].context);
+        }
+    }
+    free(devices);
+    state->devices = NULL;
+}
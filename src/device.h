@@ -0,0 +1,36 @@
+// Memory-mapped devices, taking the loads and stores to their address range
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAX_DEVICES 8
+
+// Access callbacks receive the offset of the access from the device base
+typedef uint64_t (*DeviceRead)(void *context, uint64_t offset, int bytes);
+typedef void (*DeviceWrite)(void *context, uint64_t offset, uint64_t value, int bytes);
+typedef void (*DeviceReset)(void *context);
+typedef void (*DeviceRelease)(void *context);
+
+typedef struct {
+    const char *name;
+    uint64_t base;
+    uint64_t size;
+    DeviceRead read;
+    DeviceWrite write;
+    DeviceReset reset; // NULL if the device keeps no state
+    DeviceRelease release; // frees the context, NULL if it is not owned by the device
+    void *context;
+} Device;
+
+
+// Prototypes
+extern void registerDevice(const Device *device);
+extern const Device *findDevice(uint64_t addr);
+extern bool deviceInPage(uint64_t pageBase, uint64_t pageSize);
+extern void resetDevices(void);
+extern void freeDevices(void);
+
+#endif
@@ -10,6 +10,15 @@
 #include "utils_as.h"
 
 
+// Tags of the conditions in pairs, the second of each pair negated
+static const uint8_t conditionTags[] = { EQ_NE_TAG, GE_LT_TAG, GT_LE_TAG, ALWAYS_TAG };
+
+static struct Condition toCondition(char *cond)
+{
+    int pos = getCondition(cond);
+    return (struct Condition){ .tag = conditionTags[pos / 2], .neg = pos % 2 };
+}
+
 static int disassembleDPI(InstructionParse *instr, Instruction *instruction)
 {
     instruction->instructionType = isDPI;
@@ -54,6 +63,25 @@ static int disassembleDPR(InstructionParse *instr, Instruction *instruction)
         return EXIT_SUCCESS;
     }
 
+    int dividePos = getPositionInArray(instr->instrname, divide, DIVIDE_SIZE);
+    if (dividePos != NOT_FOUND) { // Divide - udiv, sdiv
+        dpr->opc = DPR_OPC;
+        dpr->m = 1;
+        dpr->opr = DPR_DIVIDE;
+        dpr->opcode = UDIV_OPCODE + dividePos;
+        return EXIT_SUCCESS;
+    }
+
+    int selectPos = getPositionInArray(instr->instrname, conditionalSelect, SELECT_SIZE);
+    if (selectPos != NOT_FOUND) { // Conditional Select - csel, csinc, csinv, csneg
+        dpr->opc = (selectPos / 2) * SELECT_INVERT;
+        dpr->m = 1;
+        dpr->opr = DPR_SELECT;
+        dpr->op2 = selectPos % 2;
+        dpr->cond = toCondition(instr->tokens[3]);
+        return EXIT_SUCCESS;
+    }
+
     // Arithmetic / Bit-logic
     dpr->m = 0;
     dpr->shift = (instr->numTokens > NUM_EXISTS_SH) ? getShift(instr->tokens[3]) : 0;
@@ -74,6 +102,28 @@ static int disassembleDPR(InstructionParse *instr, Instruction *instruction)
 }
 
 // 2.3.2 Single Data Transfer Instructions
+// Load and store pairs: [xn], [xn, #imm], [xn, #imm]! or [xn], #imm with imm a multiple of the size
+static int disassemblePair(InstructionParse *instr, struct SDT *sdt)
+{
+    sdt->mode = 1;
+    sdt->l = (instr->instrname[0] == 'l');
+    sdt->rt2 = getRegister(instr->tokens[1]);
+    sdt->xn = getRegister(instr->tokens[2] + 1); // remove [
+
+    int offset = 0;
+    sdt->index = PAIR_OFFSET;
+    if (instr->numTokens > 3) {
+        offset = getImmediate(instr->tokens[3]);
+        if (strchr(instr->tokens[2], ']') != NULL) {
+            sdt->index = PAIR_POST_INDEX;
+        } else if (strchr(instr->tokens[3], '!') != NULL) {
+            sdt->index = PAIR_PRE_INDEX;
+        }
+    }
+    sdt->simm7 = offset / (sdt->sf ? SDT_IMM12_64 : SDT_IMM12_32);
+    return EXIT_SUCCESS;
+}
+
 static int disassembleSDT(InstructionParse *instr, Instruction *instruction)
 {
     instruction->instructionType = isSDT;
@@ -81,6 +131,10 @@ static int disassembleSDT(InstructionParse *instr, Instruction *instruction)
 
     sdt->sf = getMode(instr->tokens[0]);
     sdt->rt = getRegister(instr->tokens[0]);
+    sdt->pair = (instr->instrname[2] == 'p');
+    if (sdt->pair) {
+        return disassemblePair(instr, sdt);
+    }
 
     // Check address: register or literal
     if (strchr(instr->tokens[1], '[') != NULL) { // Single Data Transfer
@@ -133,47 +187,46 @@ static int disassembleB(InstructionParse *instr, Instruction *instruction)
     instruction->instructionType = isB;
     struct B *b = &(instruction->b);
 
-    if (!strcmp(instr->instrname, "b")) { // Unconditional
-        b->type = BRANCH_UNCONDITIONAL;
+    if (!strcmp(instr->instrname, "b") || !strcmp(instr->instrname, "bl")) { // Unconditional, with link
+        b->type = (instr->instrname[1] == 'l') ? BRANCH_LINK : BRANCH_UNCONDITIONAL;
         int literal = getLiteral(instr->tokens[0], symtable);
         if (literal == INT32_MIN) {
             updateUndefTable(bu, instr->tokens[0]);
         }
         b->simm26 = (literal - PC * INSTR_BYTES) / INSTR_BYTES;
-    } else if (!strcmp(instr->instrname, "br")) { // Register
+    } else if (instr->instrname[1] == 'b') { // Compare and test - cbz, cbnz, tbz and tbnz
+        b->rt = getRegister(instr->tokens[0]);
+        b->nonzero = (instr->instrname[2] == 'n');
+        int label = 1;
+        if (*instr->instrname == 't') {
+            int bit = getLiteral(instr->tokens[1], symtable);
+            b->type = BRANCH_TEST;
+            b->sf = bit >> 5;
+            b->b40 = bit & 0x1F;
+            label = 2;
+        } else {
+            b->type = BRANCH_COMPARE;
+            b->sf = getMode(instr->tokens[0]);
+        }
+        int literal = getLiteral(instr->tokens[label], symtable);
+        if (literal == INT32_MIN) {
+            updateUndefTable((b->type == BRANCH_TEST) ? bt : bc, instr->tokens[label]);
+        }
+        b->simm = (literal - PC * INSTR_BYTES) / INSTR_BYTES;
+    } else if (instr->instrname[1] != '.') { // Register - br, blr and ret
         b->type = BRANCH_REGISTER;
         b->bit = B_BIT;
         b->reg = B_REG;
-        b->xn = getRegister(instr->tokens[0]);
+        if (!strcmp(instr->instrname, "ret")) { // Returns through x30 unless given a register
+            b->opc = RET_OPC;
+            b->xn = (instr->numTokens > 0) ? getRegister(instr->tokens[0]) : LINK_REGISTER;
+        } else {
+            b->opc = (!strcmp(instr->instrname, "blr")) ? BLR_OPC : BR_OPC;
+            b->xn = getRegister(instr->tokens[0]);
+        }
     } else { // Conditional
         b->type = BRANCH_CONDITIONAL;
-
-        // Take by cases regarding the mnemonic
-        char *p = instr->instrname + 2;
-        switch (*p) {
-            case 'e': // eq - 0000
-                b->cond.tag = EQ_NE_TAG;
-                b->cond.neg = EQ_NEG;
-                break;
-            case 'n': // ne - 0001
-                b->cond.tag = EQ_NE_TAG;
-                b->cond.neg = NE_NEG;
-                break;
-            case 'g': // ge - 1010 and gt - 1100
-                b->cond.tag = (*(p + 1) == 'e') ? GE_LT_TAG : GT_LE_TAG;
-                b->cond.neg = GE_NEG;
-                break;
-            case 'l': // lt - 1011 and le - 1101
-                b->cond.tag = (*(p + 1) == 't') ? GE_LT_TAG : GT_LE_TAG;
-                b->cond.neg = LT_NEG;
-                break;
-            case 'a': // al - 1110
-                b->cond.tag = ALWAYS_TAG;
-                b->cond.neg = ALWAYS_NEG;
-                break;
-            default:
-                EXIT_PROGRAM("Unrecognized conditional branch.");
-        }
+        b->cond = toCondition(instr->instrname + 2); // after "b."
         int literal = getLiteral(instr->tokens[0], symtable);
         if (literal == INT32_MIN) {
             updateUndefTable(bc, instr->tokens[0]);
@@ -198,6 +251,14 @@ static int disassembleAlias(InstructionParse *instr, Instruction *instruction)
     } else if (idx == NEG || idx == NEGS || idx == MVN || idx == MOV) {
         // Add rzr as 2nd token - neg, negs, mvn, mov
         insertNewToken(instr->tokens, mode ? XZR : WZR, &(instr->numTokens), 1);
+    } else if (idx >= CSET) {
+        // Add rzr as 2nd and 3rd tokens - cset, csetm, or repeat rn - cinc, cinv, cneg
+        if (idx == CSET || idx == CSETM) {
+            insertNewToken(instr->tokens, mode ? XZR : WZR, &(instr->numTokens), 1);
+        }
+        insertNewToken(instr->tokens, instr->tokens[1], &(instr->numTokens), 2);
+        // The selected operand is taken when the condition fails, so invert it
+        strcpy(instr->tokens[3], conditions[getCondition(instr->tokens[3]) ^ 1]);
     } else {
         // Add rzr as 4th token - mul, mneg
         insertNewToken(instr->tokens, mode ? XZR : WZR, &(instr->numTokens), 3);
@@ -0,0 +1,485 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "cache.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "dispatch.h"
+#include "execute.h"
+#include "io.h"
+#include "status.h"
+#include "structs.h"
+
+// Labels as values are a GNU extension, other compilers dispatch through a switch
+#if defined(__GNUC__)
+#define THREADED_DISPATCH
+#endif
+
+
+extern _Thread_local struct EmulatorState *state;
+
+//
+// Handler Selection
+//
+static const uint8_t arithmeticHandlers[][2] = {
+    [ADD] = {H_ADD_IMM_32, H_ADD_REG_32},
+    [ADD_SETFLAGS] = {H_ADDS_IMM_32, H_ADDS_REG_32},
+    [SUB] = {H_SUB_IMM_32, H_SUB_REG_32},
+    [SUB_SETFLAGS] = {H_SUBS_IMM_32, H_SUBS_REG_32}
+};
+
+// Indexed by opc and N
+static const uint8_t logicalHandlers[][2] = {
+    [BITWISE_AND] = {H_AND_32, H_BIC_32},
+    [BITWISE_OR] = {H_ORR_32, H_ORN_32},
+    [BITWISE_XOR] = {H_EOR_32, H_EON_32},
+    [BITWISE_AND_SETFLAGS] = {H_ANDS_32, H_BICS_32}
+};
+
+// Indexed by the condition tag, the negated condition follows each handler
+static const uint8_t conditionHandlers[] = {
+    [EQ_NE_TAG] = H_B_EQ,
+    [GE_LT_TAG] = H_B_GE,
+    [GT_LE_TAG] = H_B_GT,
+    [ALWAYS_TAG] = H_B_AL
+};
+
+// Resolve the handler for the exact form of the instruction, 64-bit forms follow the 32-bit ones
+uint8_t selectHandler(const Instruction *instruction)
+{
+    switch (instruction->instructionType) {
+        case isDPI: {
+            const struct DPI *dpi = &instruction->dpi;
+            if (dpi->opi == ARITHMETIC) {
+                return arithmeticHandlers[dpi->opc][0] + dpi->sf;
+            } else if (dpi->opi == WIDEMOVE) {
+                switch (dpi->opc) {
+                    case MOVE_WITH_NOT:
+                        return H_MOVN_32 + dpi->sf;
+                    case MOVE_WITH_ZERO:
+                        return H_MOVZ_32 + dpi->sf;
+                    case MOVE_WITH_KEEP:
+                        return H_MOVK_32 + dpi->sf;
+                }
+            }
+            return H_FALLBACK;
+        }
+        case isDPR: {
+            const struct DPR *dpr = &instruction->dpr;
+            if (dpr->m == 1 && dpr->opr == DPR_SELECT) {
+                return H_CSEL_32 + dpr->sf;
+            }
+            if (dpr->m == 1 && dpr->opr == DPR_DIVIDE) {
+                return H_DIV_32 + dpr->sf;
+            }
+            if (dpr->m == 1) {
+                return ((dpr->x == 0) ? H_MADD_32 : H_MSUB_32) + dpr->sf;
+            }
+            return (dpr->armOrLog ? arithmeticHandlers[dpr->opc][1]
+                                  : logicalHandlers[dpr->opc][dpr->n]) + dpr->sf;
+        }
+        case isSDT: {
+            const struct SDT *sdt = &instruction->sdt;
+            if (sdt->pair) {
+                return (sdt->l == 1) ? H_LDP : H_STP;
+            }
+            if (sdt->mode == 0) {
+                return H_LDR_LIT_32 + sdt->sf;
+            }
+            uint8_t handler = (sdt->u == 1) ? H_LDR_UOFF_32
+                            : (sdt->offmode == 0) ? H_LDR_INDEX_32
+                            : H_LDR_REG_32;
+            return handler + ((sdt->l == 1) ? 0 : 2) + sdt->sf;
+        }
+        case isB: {
+            const struct B *b = &instruction->b;
+            switch (b->type) {
+                case BRANCH_UNCONDITIONAL:
+                    return H_B;
+                case BRANCH_LINK:
+                    return H_BL;
+                case BRANCH_REGISTER: // ret branches like br
+                    if (b->opc > RET_OPC) {
+                        return H_FALLBACK;
+                    }
+                    return (b->opc == BLR_OPC) ? H_BLR : H_BR;
+                case BRANCH_COMPARE:
+                    return (b->nonzero ? H_CBNZ_32 : H_CBZ_32) + b->sf;
+                case BRANCH_TEST:
+                    return b->nonzero ? H_TBNZ : H_TBZ;
+                case BRANCH_CONDITIONAL:
+                    if (b->cond.tag < sizeof(conditionHandlers) && conditionHandlers[b->cond.tag] != H_FALLBACK) {
+                        return conditionHandlers[b->cond.tag] + b->cond.neg;
+                    }
+                    return H_FALLBACK;
+            }
+            return H_FALLBACK;
+        }
+    }
+    return H_FALLBACK;
+}
+
+//
+// Handlers
+//
+// Each handler has the semantics of the matching path through execute()
+static inline void mask(bool sf, int64_t *reg)
+{
+    if (!sf) {
+        *reg &= MASK32;
+    }
+}
+
+static inline void addImmediate(const struct DPI *dpi, bool sf, bool isAdd, bool setFlags)
+{
+    int64_t *Rd = (dpi->rd == ZR_SP) ? &state->SP : &state->R[dpi->rd];
+    int64_t imm12 = ((int64_t)dpi->imm12) << (dpi->sh * ARITHMETIC_SHIFT);
+    int64_t Rn = (dpi->rn == ZR_SP) ? state->SP : state->R[dpi->rn];
+    mask(sf, &Rn);
+
+    if (!setFlags || dpi->rd != ZR_SP) {
+        *Rd = isAdd ? Rn + imm12 : Rn - imm12;
+    }
+    if (setFlags) {
+        updateFlagsArithmetic(Rn, imm12, sf, isAdd);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+static inline void moveWide(const struct DPI *dpi, bool sf, uint8_t opc)
+{
+    int64_t *Rd = (dpi->rd == ZR_SP) ? &state->SP : &state->R[dpi->rd];
+    if (dpi->rd != ZR_SP) {
+        uint64_t imm16 = ((uint64_t)dpi->imm16) << (dpi->hw * WIDEMOVE_SHIFT);
+        if (opc == MOVE_WITH_NOT) {
+            *Rd = ~imm16;
+        } else if (opc == MOVE_WITH_ZERO) {
+            *Rd = imm16;
+        } else {
+            int64_t keep = MASK16 << (dpi->hw * WIDEMOVE_SHIFT);
+            *Rd = (*Rd & ~keep) | imm16;
+        }
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+// Operands of a register instruction, Rn reads the zero register whenever Rm does
+static inline void registerOperands(const struct DPR *dpr, bool sf, int64_t *Rn, int64_t *Rm)
+{
+    *Rm = (dpr->rm != ZR_SP) ? state->R[dpr->rm] : state->ZR;
+    *Rn = (dpr->rm != ZR_SP) ? state->R[dpr->rn] : state->ZR;
+    mask(sf, Rm);
+    mask(sf, Rn);
+}
+
+static inline void addRegister(const struct DPR *dpr, bool sf, bool isAdd, bool setFlags)
+{
+    int64_t *Rd = &state->R[dpr->rd];
+    int64_t Rn, Rm, op2;
+    registerOperands(dpr, sf, &Rn, &Rm);
+    shift(Rm, &op2, dpr->operand, dpr->shift, sf);
+
+    if (!setFlags || dpr->rd != ZR_SP) {
+        *Rd = isAdd ? Rn + op2 : Rn - op2;
+    }
+    if (setFlags) {
+        updateFlagsArithmetic(Rn, op2, sf, isAdd);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+static inline void logical(const struct DPR *dpr, bool sf, uint8_t opc, bool negate)
+{
+    int64_t *Rd = &state->R[dpr->rd];
+    int64_t Rn, Rm, op2;
+    registerOperands(dpr, sf, &Rn, &Rm);
+    shift(Rm, &op2, dpr->operand, dpr->shift, sf);
+    if (negate) {
+        op2 = ~op2;
+    }
+
+    if (opc == BITWISE_AND) {
+        *Rd = Rn & op2;
+    } else if (opc == BITWISE_OR) {
+        *Rd = Rn | op2;
+    } else if (opc == BITWISE_XOR) {
+        *Rd = Rn ^ op2;
+    } else {
+        if (dpr->rd != ZR_SP) {
+            *Rd = Rn & op2;
+        }
+        updateFlagsAnd(Rn, op2, sf);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+static inline void multiply(const struct DPR *dpr, bool sf, bool subtract)
+{
+    int64_t *Rd = &state->R[dpr->rd];
+    int64_t Rn, Rm;
+    registerOperands(dpr, sf, &Rn, &Rm);
+
+    if (dpr->rd != ZR_SP) {
+        int64_t Ra = (dpr->ra != ZR_SP) ? state->R[dpr->ra] : state->ZR;
+        *Rd = subtract ? Ra - (Rn * Rm) : Ra + (Rn * Rm);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+// csel, csinc, csinv and csneg
+static inline void conditional(const struct DPR *dpr, bool sf)
+{
+    int64_t *Rd = &state->R[dpr->rd];
+    if (dpr->rd != ZR_SP) {
+        *Rd = conditionalSelect(dpr);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+// udiv and sdiv
+static inline void quotient(const struct DPR *dpr, bool sf)
+{
+    int64_t *Rd = &state->R[dpr->rd];
+    if (dpr->rd != ZR_SP) {
+        *Rd = divide(dpr);
+    }
+    mask(sf, Rd);
+    state->PC += INSTR_BYTES;
+}
+
+// Addressing modes of the single data transfer handlers
+enum addressing {
+    UNSIGNED_OFFSET,
+    PRE_POST_INDEX,
+    REGISTER_OFFSET,
+    LITERAL
+};
+
+static inline void transfer(const struct SDT *sdt, bool sf, bool load, enum addressing addressing)
+{
+    uint64_t targetAddress;
+    mask(sf, &state->R[sdt->rt]);
+
+    if (addressing == LITERAL) {
+        targetAddress = state->PC + ((int64_t)sdt->simm19) * INSTR_BYTES;
+    } else {
+        int64_t *Xn = (sdt->xn == ZR_SP) ? &state->SP : &state->R[sdt->xn];
+        targetAddress = *Xn;
+        if (addressing == UNSIGNED_OFFSET) {
+            targetAddress += (uint16_t)(sdt->imm12 * (sf ? MODE64_BYTES : MODE32_BYTES));
+        } else if (addressing == PRE_POST_INDEX) {
+            targetAddress += (sdt->i) ? sdt->simm9 : 0;
+            *Xn += (int64_t)sdt->simm9;
+        } else {
+            targetAddress += (sdt->xn == ZR_SP) ? state->SP : state->R[sdt->xm];
+        }
+    }
+
+    if (load) {
+        loadFromMemory(targetAddress, &state->R[sdt->rt], sf);
+    } else {
+        storeToMemory(targetAddress, state->R[sdt->rt], sf);
+    }
+    state->PC += INSTR_BYTES;
+}
+
+// Z straight from the recorded result, without evaluating the other flags
+static inline bool zeroFlag(void)
+{
+    return (state->flagOp.kind == FLAGS_EVALUATED) ? state->pstate.Z : (state->flagOp.result == 0);
+}
+
+static inline void branchIf(const struct B *b, bool condition)
+{
+    state->PC += condition ? ((int64_t)b->simm19) * INSTR_BYTES : INSTR_BYTES;
+}
+
+// cbz and cbnz
+static inline void compareBranch(const struct B *b, bool sf, bool nonzero)
+{
+    uint64_t value = (b->rt == ZR_SP) ? state->ZR : state->R[b->rt];
+    bool zero = (sf ? value : (uint32_t)value) == 0;
+    state->PC += (zero ^ nonzero) ? ((int64_t)b->simm) * INSTR_BYTES : INSTR_BYTES;
+}
+
+// tbz and tbnz
+static inline void testBranch(const struct B *b, bool nonzero)
+{
+    uint64_t value = (b->rt == ZR_SP) ? state->ZR : state->R[b->rt];
+    bool zero = ((value >> (b->sf * 32 + b->b40)) & 1) == 0;
+    state->PC += (zero ^ nonzero) ? ((int64_t)b->simm) * INSTR_BYTES : INSTR_BYTES;
+}
+
+//
+// Dispatch
+//
+#if defined(THREADED_DISPATCH)
+#define LABEL_ADDRESS(name) &&L_##name,
+#define CASE(name) L_##name
+#define DISPATCH() goto *labels[handlers[i]]
+#else
+#define CASE(name) case H_##name
+#define DISPATCH() goto dispatch
+#endif
+
+// Move on to the next instruction of the sequence
+#define NEXT()                          \
+    do {                                \
+        state->retired++;                \
+        if (++i == length) {            \
+            return;                     \
+        }                               \
+        instruction = &instructions[i]; \
+        DISPATCH();                     \
+    } while (0)
+
+// A store leaves the sequence once it has overwritten translated code
+#define NEXT_AFTER_STORE()           \
+    do {                             \
+        if (state->translatedCodeWritten) { \
+            state->retired++;         \
+            return;                  \
+        }                            \
+        NEXT();                      \
+    } while (0)
+
+#if defined(THREADED_DISPATCH)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+// Run a straight-line sequence of instructions through their handlers, jumping
+// directly from each handler to the next
+void executeHandlers(const Instruction *instructions, const uint8_t *handlers, int length)
+{
+    if (length == 0) {
+        return;
+    }
+    int i = 0;
+    const Instruction *instruction = &instructions[0];
+
+#if defined(THREADED_DISPATCH)
+    static const void *labels[] = { HANDLERS(LABEL_ADDRESS) };
+    DISPATCH();
+#else
+dispatch:
+    switch (handlers[i]) {
+#endif
+
+    CASE(FALLBACK): {
+        int executeError = execute(*instruction);
+        checkError(executeError);
+        NEXT_AFTER_STORE();
+    }
+
+    CASE(ADD_IMM_32): addImmediate(&instruction->dpi, false, true, false); NEXT();
+    CASE(ADD_IMM_64): addImmediate(&instruction->dpi, true, true, false); NEXT();
+    CASE(ADDS_IMM_32): addImmediate(&instruction->dpi, false, true, true); NEXT();
+    CASE(ADDS_IMM_64): addImmediate(&instruction->dpi, true, true, true); NEXT();
+    CASE(SUB_IMM_32): addImmediate(&instruction->dpi, false, false, false); NEXT();
+    CASE(SUB_IMM_64): addImmediate(&instruction->dpi, true, false, false); NEXT();
+    CASE(SUBS_IMM_32): addImmediate(&instruction->dpi, false, false, true); NEXT();
+    CASE(SUBS_IMM_64): addImmediate(&instruction->dpi, true, false, true); NEXT();
+
+    CASE(MOVN_32): moveWide(&instruction->dpi, false, MOVE_WITH_NOT); NEXT();
+    CASE(MOVN_64): moveWide(&instruction->dpi, true, MOVE_WITH_NOT); NEXT();
+    CASE(MOVZ_32): moveWide(&instruction->dpi, false, MOVE_WITH_ZERO); NEXT();
+    CASE(MOVZ_64): moveWide(&instruction->dpi, true, MOVE_WITH_ZERO); NEXT();
+    CASE(MOVK_32): moveWide(&instruction->dpi, false, MOVE_WITH_KEEP); NEXT();
+    CASE(MOVK_64): moveWide(&instruction->dpi, true, MOVE_WITH_KEEP); NEXT();
+
+    CASE(ADD_REG_32): addRegister(&instruction->dpr, false, true, false); NEXT();
+    CASE(ADD_REG_64): addRegister(&instruction->dpr, true, true, false); NEXT();
+    CASE(ADDS_REG_32): addRegister(&instruction->dpr, false, true, true); NEXT();
+    CASE(ADDS_REG_64): addRegister(&instruction->dpr, true, true, true); NEXT();
+    CASE(SUB_REG_32): addRegister(&instruction->dpr, false, false, false); NEXT();
+    CASE(SUB_REG_64): addRegister(&instruction->dpr, true, false, false); NEXT();
+    CASE(SUBS_REG_32): addRegister(&instruction->dpr, false, false, true); NEXT();
+    CASE(SUBS_REG_64): addRegister(&instruction->dpr, true, false, true); NEXT();
+
+    CASE(AND_32): logical(&instruction->dpr, false, BITWISE_AND, false); NEXT();
+    CASE(AND_64): logical(&instruction->dpr, true, BITWISE_AND, false); NEXT();
+    CASE(BIC_32): logical(&instruction->dpr, false, BITWISE_AND, true); NEXT();
+    CASE(BIC_64): logical(&instruction->dpr, true, BITWISE_AND, true); NEXT();
+    CASE(ORR_32): logical(&instruction->dpr, false, BITWISE_OR, false); NEXT();
+    CASE(ORR_64): logical(&instruction->dpr, true, BITWISE_OR, false); NEXT();
+    CASE(ORN_32): logical(&instruction->dpr, false, BITWISE_OR, true); NEXT();
+    CASE(ORN_64): logical(&instruction->dpr, true, BITWISE_OR, true); NEXT();
+    CASE(EOR_32): logical(&instruction->dpr, false, BITWISE_XOR, false); NEXT();
+    CASE(EOR_64): logical(&instruction->dpr, true, BITWISE_XOR, false); NEXT();
+    CASE(EON_32): logical(&instruction->dpr, false, BITWISE_XOR, true); NEXT();
+    CASE(EON_64): logical(&instruction->dpr, true, BITWISE_XOR, true); NEXT();
+    CASE(ANDS_32): logical(&instruction->dpr, false, BITWISE_AND_SETFLAGS, false); NEXT();
+    CASE(ANDS_64): logical(&instruction->dpr, true, BITWISE_AND_SETFLAGS, false); NEXT();
+    CASE(BICS_32): logical(&instruction->dpr, false, BITWISE_AND_SETFLAGS, true); NEXT();
+    CASE(BICS_64): logical(&instruction->dpr, true, BITWISE_AND_SETFLAGS, true); NEXT();
+
+    CASE(MADD_32): multiply(&instruction->dpr, false, false); NEXT();
+    CASE(MADD_64): multiply(&instruction->dpr, true, false); NEXT();
+    CASE(MSUB_32): multiply(&instruction->dpr, false, true); NEXT();
+    CASE(MSUB_64): multiply(&instruction->dpr, true, true); NEXT();
+    CASE(CSEL_32): conditional(&instruction->dpr, false); NEXT();
+    CASE(CSEL_64): conditional(&instruction->dpr, true); NEXT();
+    CASE(DIV_32): quotient(&instruction->dpr, false); NEXT();
+    CASE(DIV_64): quotient(&instruction->dpr, true); NEXT();
+
+    CASE(LDR_UOFF_32): transfer(&instruction->sdt, false, true, UNSIGNED_OFFSET); NEXT();
+    CASE(LDR_UOFF_64): transfer(&instruction->sdt, true, true, UNSIGNED_OFFSET); NEXT();
+    CASE(STR_UOFF_32): transfer(&instruction->sdt, false, false, UNSIGNED_OFFSET); NEXT_AFTER_STORE();
+    CASE(STR_UOFF_64): transfer(&instruction->sdt, true, false, UNSIGNED_OFFSET); NEXT_AFTER_STORE();
+    CASE(LDR_INDEX_32): transfer(&instruction->sdt, false, true, PRE_POST_INDEX); NEXT();
+    CASE(LDR_INDEX_64): transfer(&instruction->sdt, true, true, PRE_POST_INDEX); NEXT();
+    CASE(STR_INDEX_32): transfer(&instruction->sdt, false, false, PRE_POST_INDEX); NEXT_AFTER_STORE();
+    CASE(STR_INDEX_64): transfer(&instruction->sdt, true, false, PRE_POST_INDEX); NEXT_AFTER_STORE();
+    CASE(LDR_REG_32): transfer(&instruction->sdt, false, true, REGISTER_OFFSET); NEXT();
+    CASE(LDR_REG_64): transfer(&instruction->sdt, true, true, REGISTER_OFFSET); NEXT();
+    CASE(STR_REG_32): transfer(&instruction->sdt, false, false, REGISTER_OFFSET); NEXT_AFTER_STORE();
+    CASE(STR_REG_64): transfer(&instruction->sdt, true, false, REGISTER_OFFSET); NEXT_AFTER_STORE();
+    CASE(LDR_LIT_32): transfer(&instruction->sdt, false, true, LITERAL); NEXT();
+    CASE(LDR_LIT_64): transfer(&instruction->sdt, true, true, LITERAL); NEXT();
+    CASE(LDP): transferPair(&instruction->sdt); state->PC += INSTR_BYTES; NEXT();
+    CASE(STP): transferPair(&instruction->sdt); state->PC += INSTR_BYTES; NEXT_AFTER_STORE();
+
+    CASE(B): state->PC += ((int64_t)instruction->b.simm26) * INSTR_BYTES; NEXT();
+    CASE(BL):
+        state->R[LINK_REGISTER] = state->PC + INSTR_BYTES;
+        state->PC += ((int64_t)instruction->b.simm26) * INSTR_BYTES;
+        NEXT();
+    CASE(BR): state->PC = (instruction->b.xn == ZR_SP) ? state->ZR : state->R[instruction->b.xn]; NEXT();
+    CASE(BLR): {
+        int64_t target = (instruction->b.xn == ZR_SP) ? state->ZR : state->R[instruction->b.xn];
+        state->R[LINK_REGISTER] = state->PC + INSTR_BYTES;
+        state->PC = target;
+        NEXT();
+    }
+    CASE(B_EQ): branchIf(&instruction->b, zeroFlag()); NEXT();
+    CASE(B_NE): branchIf(&instruction->b, !zeroFlag()); NEXT();
+    CASE(B_GE): evaluateFlags(); branchIf(&instruction->b, state->pstate.N == state->pstate.V); NEXT();
+    CASE(B_LT): evaluateFlags(); branchIf(&instruction->b, state->pstate.N != state->pstate.V); NEXT();
+    CASE(B_GT): evaluateFlags(); branchIf(&instruction->b, !state->pstate.Z && state->pstate.N == state->pstate.V); NEXT();
+    CASE(B_LE): evaluateFlags(); branchIf(&instruction->b, state->pstate.Z || state->pstate.N != state->pstate.V); NEXT();
+    CASE(B_AL): branchIf(&instruction->b, true); NEXT();
+    CASE(B_NV): branchIf(&instruction->b, false); NEXT();
+    CASE(CBZ_32): compareBranch(&instruction->b, false, false); NEXT();
+    CASE(CBZ_64): compareBranch(&instruction->b, true, false); NEXT();
+    CASE(CBNZ_32): compareBranch(&instruction->b, false, true); NEXT();
+    CASE(CBNZ_64): compareBranch(&instruction->b, true, true); NEXT();
+    CASE(TBZ): testBranch(&instruction->b, false); NEXT();
+    CASE(TBNZ): testBranch(&instruction->b, true); NEXT();
+
+#if !defined(THREADED_DISPATCH)
+        default:
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported instruction handler.");
+    }
+#endif
+}
+
+#if defined(THREADED_DISPATCH)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,41 @@
+// Threaded-code dispatch over instructions resolved to specialised handlers
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdint.h>
+#include "structs.h"
+
+// Every specialised instruction form, FALLBACK is executed by execute()
+#define HANDLERS(X)                                                           \
+    X(FALLBACK)                                                               \
+    X(ADD_IMM_32) X(ADD_IMM_64) X(ADDS_IMM_32) X(ADDS_IMM_64)                 \
+    X(SUB_IMM_32) X(SUB_IMM_64) X(SUBS_IMM_32) X(SUBS_IMM_64)                 \
+    X(MOVN_32) X(MOVN_64) X(MOVZ_32) X(MOVZ_64) X(MOVK_32) X(MOVK_64)         \
+    X(ADD_REG_32) X(ADD_REG_64) X(ADDS_REG_32) X(ADDS_REG_64)                 \
+    X(SUB_REG_32) X(SUB_REG_64) X(SUBS_REG_32) X(SUBS_REG_64)                 \
+    X(AND_32) X(AND_64) X(BIC_32) X(BIC_64) X(ORR_32) X(ORR_64)               \
+    X(ORN_32) X(ORN_64) X(EOR_32) X(EOR_64) X(EON_32) X(EON_64)               \
+    X(ANDS_32) X(ANDS_64) X(BICS_32) X(BICS_64)                               \
+    X(MADD_32) X(MADD_64) X(MSUB_32) X(MSUB_64) X(CSEL_32) X(CSEL_64)         \
+    X(DIV_32) X(DIV_64)                                                       \
+    X(LDR_UOFF_32) X(LDR_UOFF_64) X(STR_UOFF_32) X(STR_UOFF_64)               \
+    X(LDR_INDEX_32) X(LDR_INDEX_64) X(STR_INDEX_32) X(STR_INDEX_64)           \
+    X(LDR_REG_32) X(LDR_REG_64) X(STR_REG_32) X(STR_REG_64)                   \
+    X(LDR_LIT_32) X(LDR_LIT_64) X(LDP) X(STP)                                 \
+    X(B) X(BL) X(BR) X(BLR) X(B_EQ) X(B_NE) X(B_GE) X(B_LT) X(B_GT) X(B_LE) X(B_AL) X(B_NV)   \
+    X(CBZ_32) X(CBZ_64) X(CBNZ_32) X(CBNZ_64) X(TBZ) X(TBNZ)
+
+#define HANDLER_ENUM(name) H_##name,
+
+typedef enum {
+    HANDLERS(HANDLER_ENUM)
+    NUM_HANDLERS
+} Handler;
+
+
+// Prototypes
+extern uint8_t selectHandler(const Instruction *instruction);
+extern void executeHandlers(const Instruction *instructions, const uint8_t *handlers, int length);
+
+#endif
@@ -3,69 +3,346 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include <sys/mman.h>
 #include "constants.h"
-#include "datatypes_em.h"
-#include "decoders.h"
-#include "execute.h"
 #include "io.h"
-#include "utils_em.h"
+#include "libemulate.h"
 
+#define DEFAULT_CHECKPOINT_INTERVAL 100000
+#define DEFAULT_CHECKPOINT_BUDGET (64 * 1024 * 1024)
+#define DEFAULT_CLOCK_MHZ 1200 // the Cortex-A53 of a Raspberry Pi 3
+#define MAX_COMMAND 256
 
-// Emulator State
-struct EmulatorState state;
 
-// Initialize the state
-void initializeState(void)
-{
-    memset(&state, 0, sizeof(struct EmulatorState));
-    state.pstate.Z = true;
-}
+// Command line options
+static EmulatorOptions options = {
+    .decodeCache = true, .blockCache = true, .jit = false, .checkpointBudget = DEFAULT_CHECKPOINT_BUDGET
+};
+static bool diffJit = false; // run the interpreter and the JIT, comparing their final states
+static const char *gpioLogFile = NULL; // GPIO pin transitions are logged here if given
+static const char *profileFile = NULL; // the execution profile is written here if given
+static const char *sampleFile = "emulate.samples"; // the PC and call stack are sampled here with --sample
+static const char *traceFile = NULL; // every retired instruction is recorded here if given
+static const char *snapshotFile = NULL; // the state after snapshotAt instructions is saved here if given
+static uint64_t snapshotAt = 0;
+static const char *restoreFile = NULL; // the program continues from this snapshot if given
+static bool debug = false; // read debugger commands from stdin instead of running to the end
+static bool writeStats = false; // report the execution statistics on stderr
+static bool statsAsJson = false;
+static double clockMhz = DEFAULT_CLOCK_MHZ; // clock of the core the timing estimate is reported for
+
+// Seconds spent in each phase, reported with the statistics
+static double loadSeconds = 0;
+static double runSeconds = 0;
+static double dumpSeconds = 0;
 
 //
-// Pipeline Stages
+// IO Handling
 //
-// Fetch instruction from memory
-static uint32_t fetch(uint32_t addr)
+// Exit with the error message of the emulator unless status is a success
+static void checkStatus(Emulator *emulator, EmulateStatus status)
 {
-    uint32_t result = 0;
-    for (int i = 0; i < INSTR_BYTES; i++) {
-        result |= ((uint32_t)state.mem[addr + i]) << (BYTE_SIZE * i);
+    if (status != EMULATE_OK) {
+        fprintf(stderr, "%s\n", emulatorErrorMessage(emulator));
+        exit(EXIT_FAILURE);
     }
-    // The value is read from little endian memory
-    return result;
+}
+
+// Monotonic time in seconds
+static double now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
 }
 
 //
-// IO Handling
+// Debugger
 //
-static void readToMemory(FILE *file)
+static void printPosition(Emulator *emulator, EmulateStatus status)
 {
-    size_t numberOfBytes = fread(state.mem, 1, MEMORY_SIZE, file);
-    if (numberOfBytes == 0) {
-        fclose(file);
-        EXIT_PROGRAM("The file is empty.");
+    if (status == EMULATE_OK || status == EMULATE_BUDGET_EXHAUSTED) {
+        char text[EMULATOR_TEXT_SIZE];
+        int64_t pc = emulatorPC(emulator);
+        emulatorDisassemble(emulator, pc, text, sizeof(text));
+        printf("%" PRIu64 " retired, pc 0x%08" PRIx64 ": %s%s\n", emulatorRetired(emulator), pc, text,
+               (status == EMULATE_OK) ? " (halted)" : "");
+    } else if (status == EMULATE_ERROR_OUT_OF_HISTORY) {
+        printf("Not found since the oldest checkpoint kept.\n");
+    } else {
+        printf("%" PRIu64 " retired: %s\n", emulatorRetired(emulator), emulatorErrorMessage(emulator));
     }
 }
 
-static void writeFinalState(FILE *file)
+// Run the commands read from stdin, stepping forwards and backwards through the program
+static void debugProgram(Emulator *emulator)
 {
-    fprintf(file, "Registers:\n");
-    for (int i = 0; i < NUM_OF_REGISTERS; i++) {
-        fprintf(file, "X%d%d    = %016lx\n", i / 10, i % 10, state.R[i]);
-    }
-    fprintf(file, "PC     = %016lx\n", state.PC);
-    fprintf(file, "PSTATE : %c%c%c%c",
-            state.pstate.N ? 'N' : '-',
-            state.pstate.Z ? 'Z' : '-',
-            state.pstate.C ? 'C' : '-',
-            state.pstate.V ? 'V' : '-');
-    fprintf(file, "\nNon-Zero Memory:\n");
-    for (int addr = 0; addr < MEMORY_SIZE; addr += INSTR_BYTES) {
-        uint32_t binInstr = fetch(addr);
-        if (binInstr != 0) {
-            fprintf(file, "0x%08x : %08x\n", addr, binInstr);
+    char line[MAX_COMMAND];
+    char command[MAX_COMMAND];
+    printPosition(emulator, EMULATE_BUDGET_EXHAUSTED);
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *argument = NULL;
+        if (sscanf(line, "%255s", command) != 1) {
+            continue;
+        }
+        argument = line + strspn(line, " \t") + strlen(command);
+        bool hasArgument = strspn(argument, " \t\r\n") != strlen(argument);
+        uint64_t value = hasArgument ? strtoull(argument, NULL, 0) : 1;
+        uint64_t retired = emulatorRetired(emulator);
+
+        if (!strcmp(command, "step") || !strcmp(command, "s")) {
+            printPosition(emulator, emulatorRun(emulator, value));
+        } else if (!strcmp(command, "back") || !strcmp(command, "b")) {
+            printPosition(emulator, emulatorSeek(emulator, (value < retired) ? retired - value : 0));
+        } else if (!strcmp(command, "seek") && hasArgument) {
+            printPosition(emulator, emulatorSeek(emulator, value));
+        } else if (!strcmp(command, "continue") || !strcmp(command, "c")) {
+            printPosition(emulator, emulatorRun(emulator, EMULATOR_UNLIMITED));
+        } else if ((!strcmp(command, "last-write") || !strcmp(command, "w")) && hasArgument) {
+            printPosition(emulator, emulatorLastWrite(emulator, value));
+        } else if (!strcmp(command, "regs") || !strcmp(command, "r")) {
+            for (int i = 0; i < NUM_OF_REGISTERS; i++) {
+                printf("x%-2d = %016" PRIx64 "%s", i, emulatorRegister(emulator, i), (i % 4 == 3 || i == NUM_OF_REGISTERS - 1) ? "\n" : "  ");
+            }
+            int flags = emulatorFlags(emulator);
+            printf("NZCV %d%d%d%d\n", !!(flags & EMULATOR_FLAG_N), !!(flags & EMULATOR_FLAG_Z),
+                   !!(flags & EMULATOR_FLAG_C), !!(flags & EMULATOR_FLAG_V));
+        } else if ((!strcmp(command, "mem") || !strcmp(command, "x")) && hasArgument) {
+            printf("[0x%08" PRIx64 "] = %016" PRIx64 "\n", value, emulatorReadMemory(emulator, value, 8));
+        } else if (!strcmp(command, "quit") || !strcmp(command, "q")) {
+            break;
+        } else {
+            printf("Commands: step [N], back [N], seek N, continue, last-write ADDR, regs, mem ADDR, quit\n");
         }
+        fflush(stdout);
+    }
+}
+
+// Save the state of the emulator once snapshotAt instructions have retired
+static void saveSnapshot(Emulator *emulator)
+{
+    EmulateStatus status = emulatorRun(emulator, snapshotAt);
+    if (status != EMULATE_BUDGET_EXHAUSTED) {
+        checkStatus(emulator, status);
+    }
+    FILE *file = openOutputFile(snapshotFile, NULL, "wb");
+    checkStatus(emulator, emulatorSnapshot(emulator, file));
+    checkErrorOutput(file);
+    fclose(file);
+    snapshotFile = NULL; // saved only once in differential runs
+}
+
+// Emulator with the given options, running the program, or continuing from the snapshot
+// if restoring, to the halt instruction
+static Emulator *runProgram(const EmulatorOptions *emulatorOptions, const uint8_t *program, size_t size)
+{
+    double start = now();
+    Emulator *emulator = emulatorCreate(emulatorOptions);
+    if (emulator == NULL) {
+        EXIT_PROGRAM("Failed to create the emulator.");
+    }
+    if (restoreFile != NULL) {
+        checkStatus(emulator, emulatorRestore(emulator, program, size));
+    } else {
+        checkStatus(emulator, emulatorLoad(emulator, program, size));
+    }
+    double loaded = now();
+    if (snapshotFile != NULL) {
+        saveSnapshot(emulator);
+    }
+    if (debug) {
+        debugProgram(emulator);
+        return emulator;
+    }
+    checkStatus(emulator, emulatorRun(emulator, EMULATOR_UNLIMITED));
+    loadSeconds += loaded - start;
+    runSeconds += now() - loaded;
+    return emulator;
+}
+
+// Contents of the snapshot file mapped read-only, NULL if it could not be mapped
+static uint8_t *mapSnapshot(FILE *file, size_t *size)
+{
+    if (fseek(file, 0, SEEK_END) != 0) {
+        return NULL;
+    }
+    long length = ftell(file);
+    *size = (length > 0) ? length : 0;
+    void *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    return (data != MAP_FAILED) ? data : NULL;
+}
+
+// Final state as text, freed by the caller
+static char *captureFinalState(Emulator *emulator)
+{
+    char *text;
+    size_t size;
+    FILE *file = open_memstream(&text, &size);
+    if (file == NULL) {
+        EXIT_PROGRAM("Failed to capture the final state.");
     }
+    emulatorWriteState(emulator, file);
+    fclose(file);
+    return text;
+}
+
+// Run the program interpreted and translated from the same initial state
+static Emulator *runDifferential(const uint8_t *program, size_t size)
+{
+    EmulatorOptions interpreted = options;
+    interpreted.jit = false;
+    Emulator *expectedEmulator = runProgram(&interpreted, program, size);
+    char *expected = captureFinalState(expectedEmulator);
+    emulatorDestroy(expectedEmulator);
+
+    EmulatorOptions translated = options;
+    translated.jit = true;
+    translated.gpioLog = NULL; // the pins are only logged and the samples only taken once
+    translated.samples = NULL;
+    translated.trace = NULL;
+    Emulator *emulator = runProgram(&translated, program, size);
+    char *actual = captureFinalState(emulator);
+
+    if (strcmp(expected, actual) != 0) {
+        fprintf(stderr, "JIT final state differs from the interpreter.\nExpected:\n%s\nActual:\n%s\n",
+                expected, actual);
+        exit(EXIT_FAILURE);
+    }
+    free(expected);
+    free(actual);
+    return emulator;
+}
+
+// Report the execution statistics and the time spent in each phase on stderr
+static void reportStats(Emulator *emulator)
+{
+    EmulatorStats stats;
+    emulatorStats(emulator, &stats);
+    uint64_t branches = stats.branchUnconditional + stats.branchConditional + stats.branchRegister;
+    double takenRatio = (branches > 0) ? (double)stats.takenBranches / branches : 0;
+    double mips = (runSeconds > 0) ? stats.retired / runSeconds / 1e6 : 0;
+    const struct {
+        const char *name;
+        uint64_t count;
+    } counts[] = {
+        { "retired", stats.retired },
+        { "dpi_arithmetic", stats.dpiArithmetic },
+        { "wide_move", stats.wideMove },
+        { "dpr_arithmetic", stats.dprArithmetic },
+        { "dpr_logical", stats.dprLogical },
+        { "multiply", stats.multiply },
+        { "conditional_select", stats.conditionalSelect },
+        { "divide", stats.divide },
+        { "load_literal", stats.loadLiteral },
+        { "unsigned_offset", stats.unsignedOffset },
+        { "pre_index", stats.preIndex },
+        { "post_index", stats.postIndex },
+        { "register_offset", stats.registerOffset },
+        { "pairs", stats.pairs },
+        { "branch_unconditional", stats.branchUnconditional },
+        { "branch_conditional", stats.branchConditional },
+        { "branch_register", stats.branchRegister },
+        { "taken_branches", stats.takenBranches },
+        { "bytes_loaded", stats.bytesLoaded },
+        { "bytes_stored", stats.bytesStored }
+    };
+    int numCounts = sizeof(counts) / sizeof(counts[0]);
+
+    if (statsAsJson) {
+        fprintf(stderr, "{");
+        for (int i = 0; i < numCounts; i++) {
+            fprintf(stderr, "\"%s\": %" PRIu64 ", ", counts[i].name, counts[i].count);
+        }
+        fprintf(stderr, "\"taken_ratio\": %.4f, \"mips\": %.2f, ", takenRatio, mips);
+        fprintf(stderr, "\"load_seconds\": %.6f, \"run_seconds\": %.6f, \"dump_seconds\": %.6f}\n",
+                loadSeconds, runSeconds, dumpSeconds);
+        return;
+    }
+    for (int i = 0; i < numCounts; i++) {
+        fprintf(stderr, "%-21s %" PRIu64 "\n", counts[i].name, counts[i].count);
+    }
+    fprintf(stderr, "%-21s %.4f\n%-21s %.2f\n", "taken_ratio", takenRatio, "mips", mips);
+    fprintf(stderr, "%-21s %.6f\n%-21s %.6f\n%-21s %.6f\n", "load_seconds", loadSeconds,
+            "run_seconds", runSeconds, "dump_seconds", dumpSeconds);
+}
+
+// Report the estimated cycles, and the time they take at the clock given, on stderr
+static void reportTiming(Emulator *emulator)
+{
+    EmulatorTiming timing;
+    emulatorTiming(emulator, &timing);
+    double ipc = (timing.cycles > 0) ? (double)timing.instructions / timing.cycles : 0;
+    fprintf(stderr, "%-21s %" PRIu64 "\n", "instructions", timing.instructions);
+    fprintf(stderr, "%-21s %" PRIu64 "\n", "cycles", timing.cycles);
+    fprintf(stderr, "%-21s %" PRIu64 "\n", "dual_issued", timing.dualIssued);
+    fprintf(stderr, "%-21s %" PRIu64 "\n", "load_use_stalls", timing.loadUseStalls);
+    fprintf(stderr, "%-21s %" PRIu64 "\n", "mispredicts", timing.mispredicts);
+    fprintf(stderr, "%-21s %.2f\n%-21s %.0f\n", "ipc", ipc, "clock_mhz", clockMhz);
+    fprintf(stderr, "%-21s %.6f\n", "estimated_seconds", timing.cycles / (clockMhz * 1e6));
+}
+
+//
+// Command Line
+//
+// Consume the --options, leaving the positional arguments at the start of argv
+static int parseOptions(int argc, char **argv)
+{
+    int positional = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            argv[positional++] = argv[i];
+        } else if (!strcmp(argv[i], "--no-decode-cache")) {
+            options.decodeCache = false;
+        } else if (!strcmp(argv[i], "--no-block-cache")) {
+            options.blockCache = false;
+        } else if (!strcmp(argv[i], "--jit")) {
+            options.jit = true;
+        } else if (!strcmp(argv[i], "--jit-diff")) {
+            diffJit = true;
+        } else if (!strncmp(argv[i], "--gpio-log=", strlen("--gpio-log="))) {
+            gpioLogFile = argv[i] + strlen("--gpio-log=");
+        } else if (!strncmp(argv[i], "--profile=", strlen("--profile="))) {
+            profileFile = argv[i] + strlen("--profile=");
+            options.profile = true;
+        } else if (!strcmp(argv[i], "--stats") || !strcmp(argv[i], "--stats=json")) {
+            writeStats = true;
+            statsAsJson = !strcmp(argv[i], "--stats=json");
+            options.profile = true;
+        } else if (!strcmp(argv[i], "--timing") || !strncmp(argv[i], "--timing=", strlen("--timing="))) {
+            options.timing = true;
+            if (argv[i][strlen("--timing")] == '=') {
+                clockMhz = strtod(argv[i] + strlen("--timing="), NULL);
+            }
+            if (clockMhz <= 0) {
+                EXIT_PROGRAM("Provide the clock of --timing in MHz.");
+            }
+        } else if (!strncmp(argv[i], "--save-snapshot=", strlen("--save-snapshot="))) {
+            snapshotFile = argv[i] + strlen("--save-snapshot=");
+        } else if (!strncmp(argv[i], "--at=", strlen("--at="))) {
+            snapshotAt = strtoull(argv[i] + strlen("--at="), NULL, 10);
+        } else if (!strncmp(argv[i], "--restore=", strlen("--restore="))) {
+            restoreFile = argv[i] + strlen("--restore=");
+        } else if (!strcmp(argv[i], "--debug") || !strncmp(argv[i], "--debug=", strlen("--debug="))) {
+            debug = true;
+            options.checkpointInterval = (argv[i][strlen("--debug")] == '=')
+                                       ? strtoull(argv[i] + strlen("--debug="), NULL, 10)
+                                       : DEFAULT_CHECKPOINT_INTERVAL;
+        } else if (!strncmp(argv[i], "--checkpoint-budget=", strlen("--checkpoint-budget="))) {
+            options.checkpointBudget = strtoull(argv[i] + strlen("--checkpoint-budget="), NULL, 10);
+        } else if (!strncmp(argv[i], "--trace=", strlen("--trace="))) {
+            traceFile = argv[i] + strlen("--trace=");
+        } else if (!strncmp(argv[i], "--sample=", strlen("--sample="))) {
+            options.sampleInterval = strtoul(argv[i] + strlen("--sample="), NULL, 10);
+        } else if (!strncmp(argv[i], "--sample-file=", strlen("--sample-file="))) {
+            sampleFile = argv[i] + strlen("--sample-file=");
+        } else {
+            fprintf(stderr, "Unsupported option: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return positional;
 }
 
 //
@@ -75,41 +352,77 @@ int main(int argc, char **argv)
 {
     char *inputFile;
     char *outputFile;
-    if (argc >= 2) {
+    argc = parseOptions(argc, argv);
+    if (restoreFile != NULL) {
+        inputFile = (char *)restoreFile;
+        outputFile = (argc > 1) ? argv[1] : STDOUT;
+    } else if (argc >= 2) {
         inputFile = argv[1];
         outputFile = (argc > 2) ? argv[2] : STDOUT;
     } else {
         EXIT_PROGRAM("Provide at least an input file.");
     }
 
-    // Set up initial state
-    initializeState();
-
-    // Initializing data types
-    uint32_t instr;
-    Instruction *instruction = initializeInstruction();
+    // Map the devices
+    options.gpioLog = (gpioLogFile != NULL) ? openOutputFile(gpioLogFile, NULL, "w") : NULL;
+    options.trace = (traceFile != NULL) ? openOutputFile(traceFile, NULL, "wb") : NULL;
+    options.samples = (options.sampleInterval > 0) ? openOutputFile(sampleFile, NULL, "wb") : NULL;
 
-    // Store instructions into memory
+    // Read the program, or map the snapshot to restore
     FILE *input = loadInputFile(inputFile, NULL, "rb");
-    readToMemory(input);
-
-    while ((instr = fetch(state.PC)) != HALT_INSTR) {
-        int decodeError = decode(&instr, instruction, getBits);
-        checkError(decodeError);
-
-        int executeError = execute(*instruction);
-        checkError(executeError);
+    size_t size;
+    uint8_t *program = (restoreFile != NULL) ? mapSnapshot(input, &size) : readWholeFile(input, &size);
+    if (program == NULL) {
+        EXIT_PROGRAM("Failed to read the program.");
+    }
+    if (size == 0) {
+        fclose(input);
+        EXIT_PROGRAM("The file is empty.");
     }
 
-    // Free data types
-    freeInstruction(instruction);
+    // Execute all instructions
+    Emulator *emulator = diffJit ? runDifferential(program, size) : runProgram(&options, program, size);
+    if (restoreFile != NULL) {
+        munmap(program, size);
+    } else {
+        free(program);
+    }
 
     // Write the final state after executing all instructions
+    double start = now();
     FILE *output = openOutputFile(outputFile, NULL, "w");
-    writeFinalState(output);
+    emulatorWriteState(emulator, output);
+    fflush(output);
+    dumpSeconds = now() - start;
+
+    if (profileFile != NULL) {
+        FILE *profile = openOutputFile(profileFile, NULL, "w");
+        emulatorWriteProfile(emulator, profile);
+        checkErrorOutput(profile);
+        if (profile != stdout) {
+            fclose(profile);
+        }
+    }
+
+    if (writeStats) {
+        reportStats(emulator);
+    }
+    if (options.timing) {
+        reportTiming(emulator);
+    }
 
     // Close files
     closeFiles(input, output);
+    if (options.gpioLog != NULL && options.gpioLog != stdout) {
+        fclose(options.gpioLog);
+    }
+    if (options.samples != NULL && options.samples != stdout) {
+        fclose(options.samples);
+    }
+    emulatorDestroy(emulator);
+    if (options.trace != NULL && options.trace != stdout) {
+        fclose(options.trace);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -2,54 +2,81 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "cache.h"
 #include "constants.h"
 #include "datatypes_em.h"
 #include "execute.h"
+#include "memory.h"
+#include "status.h"
 #include "utils_em.h"
 #include "structs.h"
 
 
-extern struct EmulatorState state;
-static int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool nbits);
+extern _Thread_local struct EmulatorState *state;
 
 static void updatePC(void)
 {
-    state.PC += INSTR_BYTES;
+    state->PC += INSTR_BYTES;
 }
 
-static void updateFlagsArithmetic(int64_t a, int64_t b, bool sf, bool isAdd)
+// Record an arithmetic flag-setting operation, the flags are computed by evaluateFlags()
+void updateFlagsArithmetic(int64_t a, int64_t b, bool sf, bool isAdd)
 {
-    int64_t res = isAdd ? a + b : a - b;
-
-    // Sign Flag (N)
-    state.pstate.N = sf ? (res < 0) : ((int32_t)res < 0);
-    // Zero Flag (Z)
-    state.pstate.Z = (res == 0);
-    // Carry Flag (C)
-    state.pstate.C = isAdd ? (sf ? ((uint64_t)res < (uint64_t)a)
-                                 : ((uint32_t)res < (uint32_t)a))
-                           : (sf ? ((uint64_t)a >= (uint64_t)b)
-                                 : ((uint32_t)a >= (uint32_t)b));
-    // Overflow Flag (V)
-    state.pstate.V = isAdd ? (sf ? (((a > 0) == (b > 0)) && ((res > 0) != (a > 0)))
-                                 : ((((int32_t)a > 0) == ((int32_t)b > 0)) && (((int32_t)res > 0) != ((int32_t)a > 0))))
-                           : (sf ? (((a > 0) != (b > 0)) && ((res > 0) == (b > 0)))
-                                 : ((((int32_t)a > 0) != ((int32_t)b > 0)) && (((int32_t)res > 0) == ((int32_t)b > 0))));
+    state->flagOp.kind = isAdd ? FLAGS_ADD : FLAGS_SUB;
+    state->flagOp.sf = sf;
+    state->flagOp.a = a;
+    state->flagOp.b = b;
+    state->flagOp.result = isAdd ? a + b : a - b;
 }
 
-static void updateFlagsAnd(int64_t a, int64_t b, bool sf)
+// Record a bitwise AND setting the flags
+void updateFlagsAnd(int64_t a, int64_t b, bool sf)
 {
-    int64_t res = a & b;
-
-    // Sign Flag (N)
-    state.pstate.N = (sf == 0) ? ((int32_t)(res & MASK32) < 0)
-                               : (res < 0);
-    // Zero Flag (Z)
-    state.pstate.Z = (res == 0);
-    // Carry Flag (C)
-    state.pstate.C = 0;
-    // Overflow Flag (V)
-    state.pstate.V = 0;
+    state->flagOp.kind = FLAGS_AND;
+    state->flagOp.sf = sf;
+    state->flagOp.a = a;
+    state->flagOp.b = b;
+    state->flagOp.result = a & b;
+}
+
+// Compute N, Z, C and V from the last flag-setting operation
+void evaluateFlags(void)
+{
+    struct FlagOp op = state->flagOp;
+    int64_t a = op.a;
+    int64_t b = op.b;
+    int64_t res = op.result;
+    bool sf = op.sf;
+
+    switch (op.kind) {
+        case FLAGS_EVALUATED:
+            return;
+        case FLAGS_AND:
+            state->pstate.N = (sf == 0) ? ((int32_t)(res & MASK32) < 0)
+                                       : (res < 0);
+            state->pstate.Z = (res == 0);
+            state->pstate.C = 0;
+            state->pstate.V = 0;
+            break;
+        default: {
+            bool isAdd = (op.kind == FLAGS_ADD);
+            // Sign Flag (N)
+            state->pstate.N = sf ? (res < 0) : ((int32_t)res < 0);
+            // Zero Flag (Z)
+            state->pstate.Z = (res == 0);
+            // Carry Flag (C)
+            state->pstate.C = isAdd ? (sf ? ((uint64_t)res < (uint64_t)a)
+                                         : ((uint32_t)res < (uint32_t)a))
+                                   : (sf ? ((uint64_t)a >= (uint64_t)b)
+                                         : ((uint32_t)a >= (uint32_t)b));
+            // Overflow Flag (V)
+            state->pstate.V = isAdd ? (sf ? (((a > 0) == (b > 0)) && ((res > 0) != (a > 0)))
+                                         : ((((int32_t)a > 0) == ((int32_t)b > 0)) && (((int32_t)res > 0) != ((int32_t)a > 0))))
+                                   : (sf ? (((a > 0) != (b > 0)) && ((res > 0) == (b > 0)))
+                                         : ((((int32_t)a > 0) != ((int32_t)b > 0)) && (((int32_t)res > 0) == ((int32_t)b > 0))));
+        }
+    }
+    state->flagOp.kind = FLAGS_EVALUATED;
 }
 
 // Arithmetic instructions in DPI and DPR
@@ -75,41 +102,122 @@ static int addOrSub(uint8_t opc, uint8_t rd, bool sf, int64_t *Rd, int64_t a, in
             updateFlagsArithmetic(a, b, sf, false);
             break;
         default:
-            EXIT_PROGRAM("Unsupported opc of data processing operation.");
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported opc of data processing operation.");
     }
     return EXIT_SUCCESS;
 }
 
-static void loadFromMemory(int addr, int64_t *reg, bool sf)
+void loadFromMemory(uint64_t addr, int64_t *reg, bool sf)
+{
+    *reg = readMemory(addr, (sf) ? MODE64_BYTES : MODE32_BYTES);
+}
+
+void storeToMemory(uint64_t addr, int64_t reg, bool sf)
 {
-    int64_t result = 0;
     int bytes = (sf) ? MODE64_BYTES : MODE32_BYTES;
-    for (int i = 0; i < bytes; i++) {
-        result |= ((int64_t)state.mem[addr + i]) << (BYTE_SIZE * i);
+    writeMemory(addr, reg, bytes);
+    invalidateDecodeCache(addr, bytes);
+}
+
+// Address of the first word a pair transfers, before any writeback
+uint64_t pairAddress(const struct SDT *sdt)
+{
+    int64_t base = (sdt->xn == ZR_SP) ? state->SP : state->R[sdt->xn];
+    int64_t offset = (int64_t)sdt->simm7 * ((sdt->sf) ? MODE64_BYTES : MODE32_BYTES);
+    return base + ((sdt->index == PAIR_POST_INDEX) ? 0 : offset);
+}
+
+// Load or store rt and rt2 to consecutive words, writing the base back unless a signed offset
+void transferPair(const struct SDT *sdt)
+{
+    int bytes = (sdt->sf) ? MODE64_BYTES : MODE32_BYTES;
+    uint64_t targetAddress = pairAddress(sdt);
+    int64_t first = state->R[sdt->rt];
+    int64_t second = state->R[sdt->rt2];
+    if (sdt->index != PAIR_OFFSET) {
+        int64_t *Xn = (sdt->xn == ZR_SP) ? &state->SP : &state->R[sdt->xn];
+        *Xn += (int64_t)sdt->simm7 * bytes;
+    }
+
+    if (sdt->l == 1) { // Load
+        loadFromMemory(targetAddress, &state->R[sdt->rt], sdt->sf);
+        loadFromMemory(targetAddress + bytes, &state->R[sdt->rt2], sdt->sf);
+    } else { // Store
+        storeToMemory(targetAddress, first, sdt->sf);
+        storeToMemory(targetAddress + bytes, second, sdt->sf);
     }
-    *reg = result;
-    // The value is read from little endian memory
 }
 
-static void storeToMemory(int addr, int64_t reg, bool sf)
+// Whether the condition of b.cond or a conditional select holds on the flags
+bool conditionHolds(struct Condition cond)
 {
-    int bytes = (sf) ? MODE64_BYTES : MODE32_BYTES;
-    for (int i = 0; i < bytes; i++) {
-        state.mem[addr + i] = (reg >> (BYTE_SIZE * i)) & MASK8;
+    bool holds;
+    evaluateFlags();
+    switch (cond.tag) {
+        case EQ_NE_TAG: // EQ (equal) - 0000, NE (not equal) - 0001
+            holds = state->pstate.Z;
+            break;
+        case GE_LT_TAG: // GE (greater or equal) - 1010, LT (less) - 1011
+            holds = (state->pstate.N == state->pstate.V);
+            break;
+        case GT_LE_TAG: // GT (greater) - 1100, LE (less or equal) - 1101
+            holds = (!state->pstate.Z && (state->pstate.N == state->pstate.V));
+            break;
+        case ALWAYS_TAG: // AL (always) - 1110
+            holds = true;
+            break;
+        default:
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported condition (bits 1-3), use either 000, 101, 110 or 111.");
+    }
+    return holds ^ cond.neg;
+}
+
+// Value csel, csinc, csinv and csneg write: rn if the condition holds, else rm, rm + 1, ~rm or -rm
+int64_t conditionalSelect(const struct DPR *dpr)
+{
+    if (conditionHolds(dpr->cond)) {
+        return (dpr->rn != ZR_SP) ? state->R[dpr->rn] : state->ZR;
+    }
+    uint64_t Rm = (dpr->rm != ZR_SP) ? state->R[dpr->rm] : state->ZR;
+    if (dpr->opc == SELECT_INVERT) {
+        return (dpr->op2 == SELECT_INCREMENT) ? -Rm : ~Rm;
+    }
+    return (dpr->op2 == SELECT_INCREMENT) ? Rm + 1 : Rm;
+}
+
+// Quotient udiv and sdiv write, rounded towards zero and 0 when dividing by zero
+int64_t divide(const struct DPR *dpr)
+{
+    uint64_t Rn = (dpr->rn != ZR_SP) ? state->R[dpr->rn] : state->ZR;
+    uint64_t Rm = (dpr->rm != ZR_SP) ? state->R[dpr->rm] : state->ZR;
+    if (!dpr->sf) {
+        Rn &= MASK32;
+        Rm &= MASK32;
+    }
+    if (Rm == 0) {
+        return 0;
     }
-    // The value is read from little endian memory
+    if (dpr->opcode == UDIV_OPCODE) {
+        return Rn / Rm;
+    }
+    int64_t dividend = dpr->sf ? (int64_t)Rn : (int32_t)Rn;
+    int64_t divisor = dpr->sf ? (int64_t)Rm : (int32_t)Rm;
+    if (divisor == -1) { // Negating wraps the most negative dividend round to itself
+        return -(uint64_t)dividend;
+    }
+    return dividend / divisor;
 }
 
 // 1.4 Data Processing Instruction (Immediate)
 static int executeDPI(Instruction instruction)
 {
     struct DPI dpi = instruction.dpi;
-    int64_t *Rd = (dpi.rd == ZR_SP) ? &state.SP : &state.R[dpi.rd];
+    int64_t *Rd = (dpi.rd == ZR_SP) ? &state->SP : &state->R[dpi.rd];
     
     switch (dpi.opi) {
         case ARITHMETIC: { // Arithmetic
             int64_t imm12 = ((int64_t)dpi.imm12) << (dpi.sh * ARITHMETIC_SHIFT);
-            int64_t Rn = (dpi.rn == ZR_SP) ? state.SP : state.R[dpi.rn];
+            int64_t Rn = (dpi.rn == ZR_SP) ? state->SP : state->R[dpi.rn];
             maskTo32Bits(dpi.sf, &Rn);
             addOrSub(dpi.opc, dpi.rd, dpi.sf, Rd, Rn, imm12);
             break;
@@ -132,12 +240,12 @@ static int executeDPI(Instruction instruction)
                     break;
                 }
                 default:
-                    EXIT_PROGRAM("Unsupported wide move type (bits 29-30), use either 00, 10 or 11.");
+                    raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported wide move type (bits 29-30), use either 00, 10 or 11.");
             }
             break;
         }
         default:
-            EXIT_PROGRAM("Unsupported opi (bits 23-25), use either 010 or 101.");
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported opi (bits 23-25), use either 010 or 101.");
     }
     maskTo32Bits(dpi.sf, Rd);
     updatePC();
@@ -147,9 +255,9 @@ static int executeDPI(Instruction instruction)
 // 1.5 Data Processing Instruction (Register)
 static int executeDPR(Instruction instruction) {
     struct DPR dpr = instruction.dpr;
-    int64_t *Rd = &state.R[dpr.rd];
-    int64_t Rm = (dpr.rm != ZR_SP) ? state.R[dpr.rm] : state.ZR;
-    int64_t Rn = (dpr.rm != ZR_SP) ? state.R[dpr.rn] : state.ZR;
+    int64_t *Rd = &state->R[dpr.rd];
+    int64_t Rm = (dpr.rm != ZR_SP) ? state->R[dpr.rm] : state->ZR;
+    int64_t Rn = (dpr.rm != ZR_SP) ? state->R[dpr.rn] : state->ZR;
 
     maskTo32Bits(dpr.sf, &Rm);
     maskTo32Bits(dpr.sf, &Rn);
@@ -183,9 +291,17 @@ static int executeDPR(Instruction instruction) {
                     break;
             }
         }
+    } else if (dpr.opr == DPR_DIVIDE) { // Divide
+        if (dpr.rd != ZR_SP) {
+            *Rd = divide(&dpr);
+        }
+    } else if (dpr.opr == DPR_SELECT) { // Conditional Select
+        if (dpr.rd != ZR_SP) {
+            *Rd = conditionalSelect(&dpr);
+        }
     } else { // Multiply
         if (dpr.rd != ZR_SP) {
-            int64_t Ra = (dpr.ra != ZR_SP) ? state.R[dpr.ra] : state.ZR;
+            int64_t Ra = (dpr.ra != ZR_SP) ? state->R[dpr.ra] : state->ZR;
             *Rd = (dpr.x == 0) ? Ra + (Rn * Rm)  // Multiply-Add
                                : Ra - (Rn * Rm); // Multiply-Sub
         }
@@ -196,7 +312,7 @@ static int executeDPR(Instruction instruction) {
 }
 
 // 1.6 Bitwise Shifts
-static int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool nbits) {
+int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool nbits) {
     amount %= (nbits) ? MODE64 : MODE32;
 
     switch (mode) {
@@ -218,7 +334,7 @@ static int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool n
             break;
         }
         default:
-            EXIT_PROGRAM("Unsupported shift mode, provide a mode between 0 and 3.");
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported shift mode, provide a mode between 0 and 3.");
     }
     return EXIT_SUCCESS;
 }
@@ -226,12 +342,18 @@ static int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool n
 // 1.7 Single Data Transfer Instruction
 static int executeSDT(Instruction instruction) {
     struct SDT sdt = instruction.sdt;
-    uint32_t targetAddress;
+    uint64_t targetAddress;
 
-    maskTo32Bits(sdt.sf, &state.R[sdt.rt]);
+    if (sdt.pair) { // Load and Store Pair
+        transferPair(&sdt);
+        updatePC();
+        return EXIT_SUCCESS;
+    }
+
+    maskTo32Bits(sdt.sf, &state->R[sdt.rt]);
 
     if (sdt.mode == 1) { // Single Data Transfer
-        int64_t *Xn = (sdt.xn == ZR_SP) ? &state.SP : &state.R[sdt.xn];
+        int64_t *Xn = (sdt.xn == ZR_SP) ? &state->SP : &state->R[sdt.xn];
         targetAddress = *Xn;
 
         if (sdt.u == 1) { // Unsigned Immediate Offset
@@ -241,22 +363,22 @@ static int executeSDT(Instruction instruction) {
             targetAddress += (sdt.i) ? sdt.simm9 : 0;
             *Xn += (int64_t)sdt.simm9;
         } else { // Register Offset
-            int64_t *Xm = (sdt.xn == ZR_SP) ? &state.SP : &state.R[sdt.xm];
+            int64_t *Xm = (sdt.xn == ZR_SP) ? &state->SP : &state->R[sdt.xm];
             targetAddress += *Xm;
         }
 
         // Simulate the Data Transfer
         if (sdt.l == 1) { // Load
-            loadFromMemory(targetAddress, &state.R[sdt.rt], sdt.sf);
+            loadFromMemory(targetAddress, &state->R[sdt.rt], sdt.sf);
         } else { // Store
-            storeToMemory(targetAddress, state.R[sdt.rt], sdt.sf);
+            storeToMemory(targetAddress, state->R[sdt.rt], sdt.sf);
         }
         
     } else { // Load Literal
-        targetAddress = state.PC + ((int64_t)sdt.simm19) * INSTR_BYTES;
+        targetAddress = state->PC + ((int64_t)sdt.simm19) * INSTR_BYTES;
 
         // Simulate the Data Transfer
-        loadFromMemory(targetAddress, &state.R[sdt.rt], sdt.sf);
+        loadFromMemory(targetAddress, &state->R[sdt.rt], sdt.sf);
     }
     updatePC();
     return EXIT_SUCCESS;
@@ -268,38 +390,44 @@ static int executeB(Instruction instruction) {
 
     switch (b.type) {
         case BRANCH_UNCONDITIONAL: // Unconditional
-            state.PC += ((int64_t)b.simm26) * INSTR_BYTES;
+            state->PC += ((int64_t)b.simm26) * INSTR_BYTES;
             break;
-        case BRANCH_CONDITIONAL: { // Conditional
-            bool toBranch;
-            switch (b.cond.tag) {
-                case EQ_NE_TAG: // EQ (equal) - 0000, NE (not equal) - 0001
-                    toBranch = state.pstate.Z;
-                    break;
-                case GE_LT_TAG: // GE (greater or equal) - 1010, LT (less) - 1011
-                    toBranch = (state.pstate.N == state.pstate.V);
-                    break;
-                case GT_LE_TAG: // GT (greater) - 1100, LE (less or equal) - 1101
-                    toBranch = (!state.pstate.Z && (state.pstate.N == state.pstate.V));
-                    break;
-                case ALWAYS_TAG: // AL (always) - 1110
-                    toBranch = true;
-                    break;
-                default:
-                    EXIT_PROGRAM("Unsupported branch condition (bits 1-3), use either 000, 101, 110 or 111.");
+        case BRANCH_LINK: // With link
+            state->R[LINK_REGISTER] = state->PC + INSTR_BYTES;
+            state->PC += ((int64_t)b.simm26) * INSTR_BYTES;
+            break;
+        case BRANCH_CONDITIONAL: // Conditional
+            if (conditionHolds(b.cond)) {
+                state->PC += ((int64_t)b.simm19) * INSTR_BYTES;
+            } else {
+                updatePC();
             }
-            if (toBranch ^ b.cond.neg) {
-                state.PC += ((int64_t)b.simm19) * INSTR_BYTES;
+            break;
+        case BRANCH_COMPARE: // Compare - cbz, cbnz
+        case BRANCH_TEST: { // Test - tbz, tbnz
+            uint64_t value = (b.rt == ZR_SP) ? state->ZR : state->R[b.rt];
+            bool zero = (b.type == BRANCH_COMPARE) ? (b.sf ? value : (uint32_t)value) == 0
+                                                   : ((value >> (b.sf * 32 + b.b40)) & 1) == 0;
+            if (zero ^ b.nonzero) {
+                state->PC += ((int64_t)b.simm) * INSTR_BYTES;
             } else {
                 updatePC();
             }
             break;
         }
-        case BRANCH_REGISTER: // Register
-            state.PC = (b.xn == ZR_SP) ? state.ZR : state.R[b.xn];
+        case BRANCH_REGISTER: { // Register - br, blr and ret
+            if (b.opc > RET_OPC) {
+                raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported register branch (bits 21-24), use either 0000, 0001 or 0010.");
+            }
+            int64_t target = (b.xn == ZR_SP) ? state->ZR : state->R[b.xn];
+            if (b.opc == BLR_OPC) {
+                state->R[LINK_REGISTER] = state->PC + INSTR_BYTES;
+            }
+            state->PC = target;
             break;
+        }
         default:
-            EXIT_PROGRAM("Unsupported branch type (bits 30-31), use either 00, 01 or 11.");
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported branch type (bits 30-31).");
     }
     return EXIT_SUCCESS;
 }
@@ -317,6 +445,6 @@ int execute(Instruction instruction)
         case isB:
             return executeB(instruction);
         default:
-            EXIT_PROGRAM("Unsupported instruction type.");
+            raiseError(EMULATE_ERROR_UNSUPPORTED, "Unsupported instruction type.");
     }
 }
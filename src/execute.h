@@ -3,10 +3,23 @@
 #ifndef EXECUTE_H
 #define EXECUTE_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "structs.h"
 
 
 // Prototypes
+extern void updateFlagsArithmetic(int64_t a, int64_t b, bool sf, bool isAdd);
+extern void updateFlagsAnd(int64_t a, int64_t b, bool sf);
+extern void evaluateFlags(void);
+extern bool conditionHolds(struct Condition cond);
+extern int64_t conditionalSelect(const struct DPR *dpr);
+extern int64_t divide(const struct DPR *dpr);
+extern void loadFromMemory(uint64_t addr, int64_t *reg, bool sf);
+extern void storeToMemory(uint64_t addr, int64_t reg, bool sf);
+extern uint64_t pairAddress(const struct SDT *sdt);
+extern void transferPair(const struct SDT *sdt);
+extern int shift(int64_t value, int64_t *op, int8_t amount, uint8_t mode, bool nbits);
 extern int execute(Instruction instruction);
 
 #endif
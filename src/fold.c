@@ -0,0 +1,97 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "io.h"
+#include "sample.h"
+
+#define FRAME_TEXT 11 // "0x%08x;"
+
+// Converts the samples written by emulate --sample to folded stacks, one line per distinct
+// stack with the number of samples taken in it, as read by flame graph tools
+
+
+static int compareStacks(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Samples as text, outermost function first and the sampled PC last, NULL if the file is
+// truncated or malformed
+static char **readStacks(const uint8_t *data, size_t size, size_t *count)
+{
+    if (size < SAMPLE_MAGIC_BYTES + sizeof(uint32_t) || memcmp(data, SAMPLE_MAGIC, SAMPLE_MAGIC_BYTES) != 0) {
+        return NULL;
+    }
+    const uint8_t *word = data + SAMPLE_MAGIC_BYTES + sizeof(uint32_t);
+    size_t words = (size - (word - data)) / sizeof(uint32_t);
+
+    // Every sample is at least two words
+    char **stacks = malloc((words / 2 + 1) * sizeof(char *));
+    if (stacks == NULL) {
+        return NULL;
+    }
+    *count = 0;
+    for (size_t i = 0; i + 2 <= words;) {
+        uint32_t pc, depth;
+        memcpy(&pc, word + i * sizeof(uint32_t), sizeof(uint32_t));
+        memcpy(&depth, word + (i + 1) * sizeof(uint32_t), sizeof(uint32_t));
+        if (depth > MAX_CALL_DEPTH || i + 2 + depth > words) {
+            break;
+        }
+        char *text = malloc((depth + 1) * FRAME_TEXT + 1);
+        if (text == NULL) {
+            break;
+        }
+        char *out = text;
+        for (uint32_t frame = 0; frame < depth; frame++) {
+            uint32_t entry;
+            memcpy(&entry, word + (i + 2 + frame) * sizeof(uint32_t), sizeof(uint32_t));
+            out += sprintf(out, "0x%08x;", entry);
+        }
+        sprintf(out, "0x%08x", pc);
+        stacks[(*count)++] = text;
+        i += 2 + depth;
+    }
+    return stacks;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        EXIT_PROGRAM("Provide a sample file.");
+    }
+    char *outputFile = (argc > 2) ? argv[2] : STDOUT;
+
+    FILE *input = loadInputFile(argv[1], NULL, "rb");
+    size_t size;
+    uint8_t *data = readWholeFile(input, &size);
+    if (data == NULL) {
+        EXIT_PROGRAM("Failed to read the sample file.");
+    }
+    size_t count;
+    char **stacks = readStacks(data, size, &count);
+    free(data);
+    if (stacks == NULL) {
+        EXIT_PROGRAM("This is not a sample file.");
+    }
+
+    // Identical stacks are adjacent once sorted
+    qsort(stacks, count, sizeof(char *), compareStacks);
+    FILE *output = openOutputFile(outputFile, NULL, "w");
+    for (size_t i = 0; i < count;) {
+        size_t same = i + 1;
+        while (same < count && !strcmp(stacks[same], stacks[i])) {
+            free(stacks[same++]);
+        }
+        fprintf(output, "%s %zu\n", stacks[i], same - i);
+        free(stacks[i]);
+        i = same;
+    }
+    free(stacks);
+
+    closeFiles(input, output);
+    return EXIT_SUCCESS;
+}
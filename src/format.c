@@ -0,0 +1,187 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "decoders.h"
+#include "format.h"
+#include "utils_em.h"
+
+#define MAX_REGISTER_NAME 8
+
+static const char *shiftNames[] = { "lsl", "lsr", "asr", "ror" };
+static const char *logicalNames[][2] = { // by opc, then N
+    { "and", "bic" }, { "orr", "orn" }, { "eor", "eon" }, { "ands", "bics" }
+};
+static const char *arithmeticNames[] = { "add", "adds", "sub", "subs" };
+
+// Condition of b.cond and the conditional selects by tag, then negated
+static const char *conditionName(uint8_t tag, bool neg)
+{
+    switch (tag) {
+        case EQ_NE_TAG:
+            return neg ? "ne" : "eq";
+        case GE_LT_TAG:
+            return neg ? "lt" : "ge";
+        case GT_LE_TAG:
+            return neg ? "le" : "gt";
+        case ALWAYS_TAG:
+            return neg ? "nv" : "al";
+        default:
+            return "??";
+    }
+}
+
+// Register name, 31 standing for the zero register or the stack pointer
+static const char *registerName(char *name, uint8_t reg, bool sf, bool isSP)
+{
+    if (reg == ZR_SP) {
+        sprintf(name, "%s", isSP ? RSP : (sf ? XZR : WZR));
+    } else {
+        sprintf(name, "%c%d", sf ? 'x' : 'w', reg);
+    }
+    return name;
+}
+
+static void formatDPI(const struct DPI *dpi, char *text, size_t size)
+{
+    char rd[MAX_REGISTER_NAME], rn[MAX_REGISTER_NAME];
+    if (dpi->opi == ARITHMETIC) {
+        snprintf(text, size, "%s %s, %s, #0x%x%s", arithmeticNames[dpi->opc],
+                 registerName(rd, dpi->rd, dpi->sf, true), registerName(rn, dpi->rn, dpi->sf, true),
+                 dpi->imm12, dpi->sh ? ", lsl #12" : "");
+    } else {
+        const char *name = (dpi->opc == MOVE_WITH_NOT) ? "movn" : (dpi->opc == MOVE_WITH_ZERO) ? "movz" : "movk";
+        snprintf(text, size, "%s %s, #0x%x, lsl #%d", name, registerName(rd, dpi->rd, dpi->sf, false),
+                 dpi->imm16, dpi->hw * WIDEMOVE_SHIFT);
+    }
+}
+
+static void formatDPR(const struct DPR *dpr, char *text, size_t size)
+{
+    char rd[MAX_REGISTER_NAME], rn[MAX_REGISTER_NAME], rm[MAX_REGISTER_NAME], ra[MAX_REGISTER_NAME];
+    registerName(rd, dpr->rd, dpr->sf, false);
+    registerName(rn, dpr->rn, dpr->sf, false);
+    registerName(rm, dpr->rm, dpr->sf, false);
+    if (dpr->m && dpr->opr == DPR_DIVIDE) {
+        snprintf(text, size, "%s %s, %s, %s", (dpr->opcode == SDIV_OPCODE) ? "sdiv" : "udiv", rd, rn, rm);
+        return;
+    }
+    if (dpr->m && dpr->opr == DPR_SELECT) {
+        static const char *selectNames[2][2] = {{"csel", "csinc"}, {"csinv", "csneg"}};
+        snprintf(text, size, "%s %s, %s, %s, %s", selectNames[dpr->opc == SELECT_INVERT][dpr->op2 == SELECT_INCREMENT],
+                 rd, rn, rm, conditionName(dpr->cond.tag, dpr->cond.neg));
+        return;
+    }
+    if (dpr->m) {
+        snprintf(text, size, "%s %s, %s, %s, %s", dpr->x ? "msub" : "madd", rd, rn, rm,
+                 registerName(ra, dpr->ra, dpr->sf, false));
+        return;
+    }
+    const char *name = dpr->armOrLog ? arithmeticNames[dpr->opc] : logicalNames[dpr->opc][dpr->n];
+    if (dpr->operand == 0) {
+        snprintf(text, size, "%s %s, %s, %s", name, rd, rn, rm);
+    } else {
+        snprintf(text, size, "%s %s, %s, %s, %s #%d", name, rd, rn, rm, shiftNames[dpr->shift], dpr->operand);
+    }
+}
+
+static void formatSDT(const struct SDT *sdt, uint64_t pc, char *text, size_t size)
+{
+    char rt[MAX_REGISTER_NAME], xn[MAX_REGISTER_NAME], xm[MAX_REGISTER_NAME];
+    registerName(rt, sdt->rt, sdt->sf, false);
+    if (!sdt->mode) {
+        snprintf(text, size, "ldr %s, 0x%08" PRIx64, rt, pc + (int64_t)sdt->simm19 * INSTR_BYTES);
+        return;
+    }
+    registerName(xn, sdt->xn, true, true);
+    if (sdt->pair) {
+        char rt2[MAX_REGISTER_NAME];
+        const char *name = sdt->l ? "ldp" : "stp";
+        int offset = sdt->simm7 * (sdt->sf ? MODE64_BYTES : MODE32_BYTES);
+        registerName(rt2, sdt->rt2, sdt->sf, false);
+        if (sdt->index == PAIR_POST_INDEX) {
+            snprintf(text, size, "%s %s, %s, [%s], #%d", name, rt, rt2, xn, offset);
+        } else {
+            snprintf(text, size, "%s %s, %s, [%s, #%d]%s", name, rt, rt2, xn, offset,
+                     (sdt->index == PAIR_PRE_INDEX) ? "!" : "");
+        }
+        return;
+    }
+    const char *name = sdt->l ? "ldr" : "str";
+    if (sdt->u) {
+        int scale = sdt->sf ? MODE64_BYTES : MODE32_BYTES;
+        snprintf(text, size, "%s %s, [%s, #%d]", name, rt, xn, sdt->imm12 * scale);
+    } else if (sdt->offmode) {
+        snprintf(text, size, "%s %s, [%s, %s]", name, rt, xn, registerName(xm, sdt->xm, true, false));
+    } else if (sdt->i) {
+        snprintf(text, size, "%s %s, [%s, #%d]!", name, rt, xn, sdt->simm9);
+    } else {
+        snprintf(text, size, "%s %s, [%s], #%d", name, rt, xn, sdt->simm9);
+    }
+}
+
+static void formatB(const struct B *b, uint64_t pc, char *text, size_t size)
+{
+    char xn[MAX_REGISTER_NAME];
+    switch (b->type) {
+        case BRANCH_UNCONDITIONAL:
+            snprintf(text, size, "b 0x%08" PRIx64, pc + (int64_t)b->simm26 * INSTR_BYTES);
+            break;
+        case BRANCH_LINK:
+            snprintf(text, size, "bl 0x%08" PRIx64, pc + (int64_t)b->simm26 * INSTR_BYTES);
+            break;
+        case BRANCH_CONDITIONAL:
+            snprintf(text, size, "b.%s 0x%08" PRIx64, conditionName(b->cond.tag, b->cond.neg),
+                     pc + (int64_t)b->simm19 * INSTR_BYTES);
+            break;
+        case BRANCH_COMPARE:
+            snprintf(text, size, "%s %s, 0x%08" PRIx64, b->nonzero ? "cbnz" : "cbz",
+                     registerName(xn, b->rt, b->sf, false), pc + (int64_t)b->simm * INSTR_BYTES);
+            break;
+        case BRANCH_TEST: // The register is named w below bit 32
+            snprintf(text, size, "%s %s, #%d, 0x%08" PRIx64, b->nonzero ? "tbnz" : "tbz",
+                     registerName(xn, b->rt, b->sf, false), b->sf * 32 + b->b40,
+                     pc + (int64_t)b->simm * INSTR_BYTES);
+            break;
+        default:
+            if (b->opc == RET_OPC && b->xn == LINK_REGISTER) {
+                snprintf(text, size, "ret");
+            } else {
+                snprintf(text, size, "%s %s", (b->opc == RET_OPC) ? "ret" : (b->opc == BLR_OPC) ? "blr" : "br",
+                         registerName(xn, b->xn, true, false));
+            }
+    }
+}
+
+// Assembly text of an instruction at pc, branch and literal targets given as addresses
+void formatInstruction(const Instruction *instruction, uint64_t pc, char *text, size_t size)
+{
+    switch (instruction->instructionType) {
+        case isDPI:
+            formatDPI(&instruction->dpi, text, size);
+            break;
+        case isDPR:
+            formatDPR(&instruction->dpr, text, size);
+            break;
+        case isSDT:
+            formatSDT(&instruction->sdt, pc, text, size);
+            break;
+        case isB:
+            formatB(&instruction->b, pc, text, size);
+            break;
+    }
+}
+
+// Assembly text of an instruction word, or a .int directive if it does not decode
+void formatWord(uint32_t word, uint64_t pc, char *text, size_t size)
+{
+    if (!isDecodable(word)) {
+        snprintf(text, size, ".int 0x%08x", word);
+        return;
+    }
+    Instruction instruction = { .instructionType = isDPI };
+    decode(&word, &instruction, getBits);
+    formatInstruction(&instruction, pc, text, size);
+}
@@ -0,0 +1,17 @@
+// Assembly text of decoded instructions, for reports and traces
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+#define MAX_INSTR_TEXT 48
+
+
+// Prototypes
+extern void formatInstruction(const Instruction *instruction, uint64_t pc, char *text, size_t size);
+extern void formatWord(uint32_t word, uint64_t pc, char *text, size_t size);
+
+#endif
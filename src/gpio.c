@@ -0,0 +1,132 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "device.h"
+#include "gpio.h"
+#include "status.h"
+
+#define FSEL_MASK 7 // 111
+#define BANK_BITS 32
+
+
+extern _Thread_local struct EmulatorState *state;
+
+typedef struct {
+    uint32_t fsel[GPIO_FSEL5 / INSTR_BYTES + 1]; // function select of each pin
+    uint64_t latch;  // output level set by SET and cleared by CLR, one bit per pin
+    uint64_t level;  // level driven on the pins
+    FILE *log;       // transitions are written here, NULL to not log them
+} Gpio;
+
+// Pins configured as outputs
+static uint64_t outputPins(const Gpio *gpio)
+{
+    uint64_t pins = 0;
+    for (int pin = 0; pin < GPIO_PINS; pin++) {
+        uint32_t fsel = gpio->fsel[pin / GPIO_PINS_PER_FSEL];
+        int shift = (pin % GPIO_PINS_PER_FSEL) * GPIO_FSEL_BITS;
+        if (((fsel >> shift) & FSEL_MASK) == GPIO_FSEL_OUTPUT) {
+            pins |= (uint64_t)1 << pin;
+        }
+    }
+    return pins;
+}
+
+// Drive the output pins from the latch, logging every pin that changes
+static void updateLevel(Gpio *gpio)
+{
+    uint64_t level = gpio->latch & outputPins(gpio);
+    uint64_t changed = level ^ gpio->level;
+    gpio->level = level;
+    if (gpio->log == NULL) {
+        return;
+    }
+    for (int pin = 0; pin < GPIO_PINS; pin++) {
+        if (changed & ((uint64_t)1 << pin)) {
+            fprintf(gpio->log, "%lu: GPIO%d %s\n", state->retired, pin,
+                    (level & ((uint64_t)1 << pin)) ? "high" : "low");
+        }
+    }
+}
+
+static uint64_t readGpio(void *context, uint64_t offset, int bytes)
+{
+    Gpio *gpio = context;
+    if (offset <= GPIO_FSEL5) {
+        return gpio->fsel[offset / INSTR_BYTES];
+    }
+    switch (offset) {
+        case GPIO_LEV0:
+            return gpio->level & MASK32;
+        case GPIO_LEV1:
+            return gpio->level >> BANK_BITS;
+        default: // SET and CLR read as zero
+            return 0;
+    }
+}
+
+static void writeGpio(void *context, uint64_t offset, uint64_t value, int bytes)
+{
+    Gpio *gpio = context;
+    uint64_t bits = value & MASK32;
+    if (offset <= GPIO_FSEL5) {
+        gpio->fsel[offset / INSTR_BYTES] = bits;
+    } else {
+        switch (offset) {
+            case GPIO_SET0:
+                gpio->latch |= bits;
+                break;
+            case GPIO_SET1:
+                gpio->latch |= bits << BANK_BITS;
+                break;
+            case GPIO_CLR0:
+                gpio->latch &= ~bits;
+                break;
+            case GPIO_CLR1:
+                gpio->latch &= ~(bits << BANK_BITS);
+                break;
+            default: // Other registers are not modelled
+                return;
+        }
+    }
+    updateLevel(gpio);
+}
+
+static void resetGpio(void *context)
+{
+    Gpio *gpio = context;
+    FILE *log = gpio->log;
+    memset(gpio, 0, sizeof(Gpio));
+    gpio->log = log;
+}
+
+static void releaseGpio(void *context)
+{
+    free(context);
+}
+
+// Map the GPIO block at its physical address, logging pin transitions to log if given
+void initializeGpio(FILE *log)
+{
+    Gpio *gpio = malloc(sizeof(Gpio));
+    if (gpio == NULL) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the GPIO block.");
+    }
+    gpio->log = log;
+    resetGpio(gpio);
+    Device device = {
+        .name = "gpio",
+        .base = GPIO_BASE,
+        .size = GPIO_SIZE,
+        .read = readGpio,
+        .write = writeGpio,
+        .reset = resetGpio,
+        .release = releaseGpio,
+        .context = gpio
+    };
+    registerDevice(&device);
+}
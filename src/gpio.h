@@ -0,0 +1,30 @@
+// BCM2837 GPIO block, logging the transitions of output pins
+
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <stdio.h>
+
+#define GPIO_BASE 0x3f200000
+#define GPIO_SIZE 0xb4
+
+// Register offsets
+#define GPIO_FSEL0 0x00 // FSEL0-FSEL5 at 0x00-0x14
+#define GPIO_FSEL5 0x14
+#define GPIO_SET0 0x1c
+#define GPIO_SET1 0x20
+#define GPIO_CLR0 0x28
+#define GPIO_CLR1 0x2c
+#define GPIO_LEV0 0x34
+#define GPIO_LEV1 0x38
+
+#define GPIO_PINS 54
+#define GPIO_FSEL_BITS 3
+#define GPIO_PINS_PER_FSEL 10
+#define GPIO_FSEL_OUTPUT 1 // 001
+
+
+// Prototypes
+extern void initializeGpio(FILE *log);
+
+#endif
@@ -48,6 +48,11 @@
 #define DPR_X_OFFSET 15
 #define DPR_RA_OFFSET 10
 
+#define DPR_TAG_OFFSET 13
+#define DPR_NEG_OFFSET 12
+#define DPR_OP2_OFFSET 10
+#define DPR_OPCODE_OFFSET 10
+
 #define DPR_SF_LEN 1
 #define DPR_M_LEN 1
 #define DPR_RM_LEN 5
@@ -64,6 +69,11 @@
 #define DPR_X_LEN 1
 #define DPR_RA_LEN 5
 
+#define DPR_TAG_LEN 3
+#define DPR_NEG_LEN 1
+#define DPR_OP2_LEN 2
+#define DPR_OPCODE_LEN 6
+
 
 #define SDT_MODE_OFFSET 31
 #define SDT_SF_OFFSET 30
@@ -87,6 +97,13 @@
 
 #define SDT_SIMM19_OFFSET 5
 
+#define SDT_PAIR_SF_OFFSET 31
+#define SDT_SINGLE_OFFSET 28
+#define SDT_VECTOR_OFFSET 26
+#define SDT_INDEX_OFFSET 23
+#define SDT_SIMM7_OFFSET 15
+#define SDT_RT2_OFFSET 10
+
 #define SDT_MODE_LEN 1
 #define SDT_SF_LEN 1
 #define SDT_MODE_LEN2 1
@@ -109,8 +126,16 @@
 
 #define SDT_SIMM19_LEN 19
 
+#define SDT_PAIR_SF_LEN 1
+#define SDT_SINGLE_LEN 1
+#define SDT_VECTOR_LEN 1
+#define SDT_INDEX_LEN 2
+#define SDT_SIMM7_LEN 7
+#define SDT_RT2_LEN 5
+
 
 #define B_TYPE_OFFSET 30
+#define B_COMPARE_OFFSET 29
 
 #define B_SIMM26_OFFSET 0
 
@@ -119,10 +144,19 @@
 #define B_NEG_OFFSET 0
 
 #define B_BIT_OFFSET 25
+#define B_OPC_OFFSET 21
 #define B_REG_OFFSET 16
 #define B_XN_OFFSET 5
 
+#define B_SF_OFFSET 31
+#define B_TEST_OFFSET 25
+#define B_NONZERO_OFFSET 24
+#define B_B40_OFFSET 19
+#define B_SIMM14_OFFSET 5
+#define B_RT_OFFSET 0
+
 #define B_TYPE_LEN 2
+#define B_COMPARE_LEN 1
 
 #define B_SIMM26_LEN 26
 
@@ -131,7 +165,15 @@
 #define B_NEG_LEN 1
 
 #define B_BIT_LEN 1
+#define B_OPC_LEN 4
 #define B_REG_LEN 5
 #define B_XN_LEN 5
 
+#define B_SF_LEN 1
+#define B_TEST_LEN 1
+#define B_NONZERO_LEN 1
+#define B_B40_LEN 5
+#define B_SIMM14_LEN 14
+#define B_RT_LEN 5
+
 #endif
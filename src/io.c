@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -44,6 +45,31 @@ FILE *openOutputFile(const char *filename, const char *extension, const char *wr
     return file;
 }
 
+// Whole contents of the file, NULL if it could not be read; freed by the caller
+uint8_t *readWholeFile(FILE *file, size_t *size)
+{
+    size_t capacity = 4096;
+    uint8_t *data = malloc(capacity);
+    *size = 0;
+    size_t numberOfBytes;
+    while (data != NULL && (numberOfBytes = fread(data + *size, 1, capacity - *size, file)) > 0) {
+        *size += numberOfBytes;
+        if (*size == capacity) {
+            capacity *= 2;
+            uint8_t *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+            }
+            data = grown;
+        }
+    }
+    if (data != NULL && ferror(file)) {
+        free(data);
+        data = NULL;
+    }
+    return data;
+}
+
 // Error Checking
 void checkError(bool error)
 {
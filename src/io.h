@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define STDOUT "stdout"
 
@@ -15,6 +16,7 @@ typedef void (*function)(FILE *);
 // Prototypes
 extern FILE *loadInputFile(const char *filename, const char *extension, const char *readMode);
 extern FILE *openOutputFile(const char *filename, const char *extension, const char *writeMode);
+extern uint8_t *readWholeFile(FILE *file, size_t *size);
 extern void checkError(bool error);
 extern void checkErrorOutput(FILE *file);
 extern void closeFiles(FILE *input, FILE *output);
@@ -0,0 +1,855 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "block.h"
+#include "cache.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "execute.h"
+#include "io.h"
+#include "jit.h"
+
+
+#if defined(__x86_64__)
+
+#include <sys/mman.h>
+
+#define JIT_BUFFER_SIZE (16 * 1024 * 1024) // 16MB
+#define MAX_INSTR_CODE 192 // upper bound on the host bytes emitted per guest instruction
+#define MAX_BLOCK_CODE ((MAX_BLOCK_LENGTH + 1) * MAX_INSTR_CODE)
+
+// Host registers, RBX holds the state pointer while a block runs
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSI 6
+#define RDI 7
+
+// Encoding prefixes and addressing modes
+#define REX_W 0x48
+#define MODRM_DISP32 0x80 // [reg + disp32]
+#define MODRM_REG 0xC0    // register direct
+
+// Opcodes of the form "op r/m, reg"
+#define OP_ADD 0x01
+#define OP_OR 0x09
+#define OP_AND 0x21
+#define OP_SUB 0x29
+#define OP_XOR 0x31
+#define OP_CMP_BYTE 0x38
+#define OP_MOV_STORE 0x89
+#define OP_MOV_LOAD 0x8B
+#define OP_LEA 0x8D
+#define OP_TEST 0x85
+#define OP_ADD_LOAD 0x03
+
+// Opcode extensions of the immediate and shift groups
+#define EXT_ADD 0
+#define EXT_SUB 5
+#define EXT_ROR 1
+#define EXT_SHL 4
+#define EXT_SHR 5
+#define EXT_SAR 7
+#define EXT_NOT 2
+#define EXT_NEG 3
+#define EXT_DIV 6
+#define EXT_IDIV 7
+#define EXT_CMP 7
+
+#define OFFSET(field) ((int32_t)offsetof(struct EmulatorState, field))
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Translation buffer of one emulator
+struct Jit {
+    uint8_t *buffer;
+    size_t used;
+};
+
+static _Thread_local uint8_t *out; // next byte to emit
+static _Thread_local int retiredSynced; // instructions of the block being compiled already added to state->retired
+
+// Host shift matching each guest shift mode
+static const uint8_t shiftExtension[] = {
+    [LOGICAL_SHIFT_LEFT] = EXT_SHL,
+    [LOGICAL_SHIFT_RIGHT] = EXT_SHR,
+    [ARITHMETIC_SHIFT_RIGHT] = EXT_SAR,
+    [ROTATE_RIGHT] = EXT_ROR
+};
+
+//
+// Guest State Layout
+//
+// Register 31 names the zero register
+static int32_t regOffset(uint8_t reg)
+{
+    return (reg == ZR_SP) ? OFFSET(ZR) : OFFSET(R) + reg * (int32_t)sizeof(int64_t);
+}
+
+// Register 31 names the stack pointer
+static int32_t spOffset(uint8_t reg)
+{
+    return (reg == ZR_SP) ? OFFSET(SP) : regOffset(reg);
+}
+
+//
+// Instruction Encoding
+//
+static void emitByte(uint8_t byte)
+{
+    *out++ = byte;
+}
+
+static void emit32(uint32_t value)
+{
+    memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+static void emit64(uint64_t value)
+{
+    memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+// op reg, [rbx + offset]
+static void emitMemOp(bool wide, uint8_t opcode, uint8_t reg, int32_t offset)
+{
+    if (wide) {
+        emitByte(REX_W);
+    }
+    emitByte(opcode);
+    emitByte(MODRM_DISP32 | (reg << 3) | RBX);
+    emit32(offset);
+}
+
+// op dst, src
+static void emitRegOp(bool wide, uint8_t opcode, uint8_t dst, uint8_t src)
+{
+    if (wide) {
+        emitByte(REX_W);
+    }
+    emitByte(opcode);
+    emitByte(MODRM_REG | (src << 3) | dst);
+}
+
+// op reg, imm32
+static void emitImmOp(bool wide, uint8_t extension, uint8_t reg, int32_t imm)
+{
+    if (wide) {
+        emitByte(REX_W);
+    }
+    emitByte(0x81);
+    emitByte(MODRM_REG | (extension << 3) | reg);
+    emit32(imm);
+}
+
+// shift reg, amount
+static void emitShift(bool wide, uint8_t extension, uint8_t reg, uint8_t amount)
+{
+    if (wide) {
+        emitByte(REX_W);
+    }
+    emitByte(0xC1);
+    emitByte(MODRM_REG | (extension << 3) | reg);
+    emitByte(amount);
+}
+
+// add qword [rbx + offset], imm32
+static void emitAddState(int32_t offset, int32_t imm)
+{
+    emitByte(REX_W);
+    emitByte(0x81);
+    emitByte(MODRM_DISP32 | (EXT_ADD << 3) | RBX);
+    emit32(offset);
+    emit32(imm);
+}
+
+static void emitLoad(uint8_t reg, int32_t offset)
+{
+    emitMemOp(true, OP_MOV_LOAD, reg, offset);
+}
+
+static void emitStore(uint8_t reg, int32_t offset)
+{
+    emitMemOp(true, OP_MOV_STORE, reg, offset);
+}
+
+static void emitLoadByte(uint8_t reg, int32_t offset)
+{
+    emitByte(0x0F); // movzx
+    emitMemOp(false, 0xB6, reg, offset);
+}
+
+static void emitMov(uint8_t dst, uint8_t src)
+{
+    emitRegOp(true, OP_MOV_STORE, dst, src);
+}
+
+// Clear the upper half of reg, as a 32-bit move does on x86-64
+static void emitMask(uint8_t reg)
+{
+    emitRegOp(false, OP_MOV_STORE, reg, reg);
+}
+
+// Apply maskTo32Bits to a register in the state
+static void emitMaskState(int32_t offset)
+{
+    emitMemOp(false, OP_MOV_LOAD, RAX, offset);
+    emitStore(RAX, offset);
+}
+
+static void emitMovImm(uint8_t reg, uint64_t value)
+{
+    if (value <= UINT32_MAX) {
+        emitByte(0xB8 + reg);
+        emit32(value);
+    } else {
+        emitByte(REX_W);
+        emitByte(0xB8 + reg);
+        emit64(value);
+    }
+}
+
+static void emitCall(uintptr_t function)
+{
+    emitMovImm(RAX, function);
+    emitByte(0xFF); // call rax
+    emitByte(0xD0);
+}
+
+static void emitSetPC(int64_t pc)
+{
+    emitMovImm(RAX, pc);
+    emitStore(RAX, OFFSET(PC));
+}
+
+static void emitReturn(void)
+{
+    emitByte(0x5B); // pop rbx
+    emitByte(0xC3); // ret
+}
+
+//
+// Flag Liveness
+//
+static bool setsFlags(Instruction *instruction)
+{
+    switch (instruction->instructionType) {
+        case isDPI: {
+            struct DPI dpi = instruction->dpi;
+            return dpi.opi == ARITHMETIC && (dpi.opc == ADD_SETFLAGS || dpi.opc == SUB_SETFLAGS);
+        }
+        case isDPR: {
+            struct DPR dpr = instruction->dpr;
+            if (dpr.m == 1) {
+                return false;
+            }
+            return dpr.armOrLog ? (dpr.opc == ADD_SETFLAGS || dpr.opc == SUB_SETFLAGS)
+                                : (dpr.opc == BITWISE_AND_SETFLAGS);
+        }
+        default:
+            return false;
+    }
+}
+
+static bool readsFlags(Instruction *instruction)
+{
+    return (instruction->instructionType == isB && instruction->b.type == BRANCH_CONDITIONAL)
+        || (instruction->instructionType == isDPR && instruction->dpr.m == 1 && instruction->dpr.opr == DPR_SELECT);
+}
+
+// Stores leave the block when they overwrite translated code, with the flags the guest expects there
+static bool leavesEarly(Instruction *instruction)
+{
+    return instruction->instructionType == isSDT && instruction->sdt.l == 0
+        && (instruction->sdt.pair || instruction->sdt.mode == 1);
+}
+
+//
+// Guest Instructions
+//
+// Interpret an instruction the translator does not handle
+static void executeFallback(Instruction *instruction)
+{
+    int executeError = execute(*instruction);
+    checkError(executeError);
+    state->retired++;
+}
+
+// Count the first count instructions of the block as executed, state->retired
+// is only brought up to date where something may read it
+static void emitRetire(int count)
+{
+    if (count > retiredSynced) {
+        emitAddState(OFFSET(retired), count - retiredSynced);
+        retiredSynced = count;
+    }
+}
+
+static void emitFallback(Instruction *instruction, int64_t pc, int index)
+{
+    emitRetire(index);
+    retiredSynced = index + 1;
+    emitSetPC(pc);
+    emitMovImm(RDI, (uintptr_t)instruction);
+    emitCall((uintptr_t)executeFallback);
+}
+
+// mov byte [rbx + offset], value
+static void emitStoreByte(int32_t offset, uint8_t value)
+{
+    emitByte(0xC6);
+    emitByte(MODRM_DISP32 | RBX);
+    emit32(offset);
+    emitByte(value);
+}
+
+// cmp byte [flagOp.kind], FLAGS_EVALUATED
+static void emitCompareKind(void)
+{
+    emitByte(0x80);
+    emitByte(MODRM_DISP32 | (7 << 3) | RBX);
+    emit32(OFFSET(flagOp.kind));
+    emitByte(FLAGS_EVALUATED);
+}
+
+// Record a flag-setting operation for lazy evaluation, with the operands in
+// RDI and RSI and the result in RAX
+static void emitRecordFlags(uint8_t kind, bool sf)
+{
+    emitStore(RDI, OFFSET(flagOp.a));
+    emitStore(RSI, OFFSET(flagOp.b));
+    emitStore(RAX, OFFSET(flagOp.result));
+    emitStoreByte(OFFSET(flagOp.sf), sf);
+    emitStoreByte(OFFSET(flagOp.kind), kind);
+}
+
+// 1.4 Data Processing Instruction (Immediate)
+static bool compileDPI(struct DPI dpi, bool needFlags)
+{
+    int32_t rd = spOffset(dpi.rd);
+    bool written = (dpi.rd != ZR_SP);
+
+    if (dpi.opi == ARITHMETIC) {
+        int32_t imm12 = (int32_t)dpi.imm12 << (dpi.sh * ARITHMETIC_SHIFT);
+        bool isAdd = (dpi.opc == ADD || dpi.opc == ADD_SETFLAGS);
+        bool setFlags = (dpi.opc == ADD_SETFLAGS || dpi.opc == SUB_SETFLAGS);
+        written = !(setFlags && dpi.rd == ZR_SP);
+
+        emitLoad(RAX, spOffset(dpi.rn));
+        if (!dpi.sf) {
+            emitMask(RAX);
+        }
+        emitMov(RDI, RAX);
+        emitImmOp(true, isAdd ? EXT_ADD : EXT_SUB, RAX, imm12);
+        if (setFlags && needFlags) {
+            emitMovImm(RSI, imm12);
+            emitRecordFlags(isAdd ? FLAGS_ADD : FLAGS_SUB, dpi.sf);
+        }
+        if (written) {
+            if (!dpi.sf) {
+                emitMask(RAX);
+            }
+            emitStore(RAX, rd);
+        }
+    } else if (written) { // Wide Move
+        uint64_t imm16 = ((uint64_t)dpi.imm16) << (dpi.hw * WIDEMOVE_SHIFT);
+        uint64_t mask = dpi.sf ? UINT64_MAX : MASK32;
+        switch (dpi.opc) {
+            case MOVE_WITH_NOT:
+                emitMovImm(RAX, ~imm16 & mask);
+                break;
+            case MOVE_WITH_ZERO:
+                emitMovImm(RAX, imm16 & mask);
+                break;
+            case MOVE_WITH_KEEP:
+                emitLoad(RAX, rd);
+                emitMovImm(RCX, ~(MASK16 << (dpi.hw * WIDEMOVE_SHIFT)));
+                emitRegOp(true, OP_AND, RAX, RCX);
+                emitMovImm(RCX, imm16);
+                emitRegOp(true, OP_OR, RAX, RCX);
+                if (!dpi.sf) {
+                    emitMask(RAX);
+                }
+                break;
+            default:
+                return false;
+        }
+        emitStore(RAX, rd);
+    }
+
+    if (!written && !dpi.sf) {
+        emitMaskState(rd);
+    }
+    return true;
+}
+
+// Evaluate a condition of b.cond or a conditional select, leaving 0 or 1 in EAX
+static bool emitCondition(struct Condition cond)
+{
+    switch (cond.tag) {
+        case EQ_NE_TAG:
+            // Z comes from the recorded result unless the flags are evaluated
+            emitLoadByte(RAX, OFFSET(pstate.Z));
+            emitLoad(RCX, OFFSET(flagOp.result));
+            emitRegOp(false, OP_XOR, RDX, RDX);
+            emitRegOp(true, OP_TEST, RCX, RCX);
+            emitByte(0x0F); // sete dl
+            emitByte(0x94);
+            emitByte(0xC2);
+            emitCompareKind();
+            emitByte(0x0F); // cmovne eax, edx
+            emitByte(0x45);
+            emitByte(MODRM_REG | (RAX << 3) | RDX);
+            break;
+        case GE_LT_TAG:
+        case GT_LE_TAG: {
+            emitCompareKind();
+            emitByte(0x74); // jz past the evaluation
+            uint8_t *skip = out++;
+            emitCall((uintptr_t)evaluateFlags);
+            *skip = out - (skip + 1);
+            emitLoadByte(RAX, OFFSET(pstate.N));
+            emitLoadByte(RCX, OFFSET(pstate.V));
+            emitRegOp(false, OP_CMP_BYTE, RAX, RCX);
+            emitByte(0x0F); // sete al
+            emitByte(0x94);
+            emitByte(0xC0);
+            if (cond.tag == GT_LE_TAG) {
+                emitLoadByte(RCX, OFFSET(pstate.Z));
+                emitByte(0x80); // xor cl, 1
+                emitByte(0xF1);
+                emitByte(0x01);
+                emitRegOp(false, 0x20, RAX, RCX); // and al, cl
+            }
+            break;
+        }
+        case ALWAYS_TAG:
+            emitMovImm(RAX, 1);
+            break;
+        default:
+            return false;
+    }
+    if (cond.neg) {
+        emitByte(0x34); // xor al, 1
+        emitByte(0x01);
+    }
+    return true;
+}
+
+// csel, csinc, csinv and csneg, with Rm transformed before the condition picks Rn or it
+static bool compileSelect(struct DPR dpr)
+{
+    if (dpr.rd == ZR_SP) {
+        return true;
+    }
+    if (!emitCondition(dpr.cond)) {
+        return false;
+    }
+    emitMov(RDI, RAX);
+    emitLoad(RCX, regOffset(dpr.rm));
+    if (dpr.opc == SELECT_INVERT) {
+        emitRegOp(true, 0xF7, RCX, (dpr.op2 == SELECT_INCREMENT) ? EXT_NEG : EXT_NOT);
+    } else if (dpr.op2 == SELECT_INCREMENT) {
+        emitImmOp(true, EXT_ADD, RCX, 1);
+    }
+    emitLoad(RAX, regOffset(dpr.rn));
+    emitRegOp(false, OP_TEST, RDI, RDI);
+    emitByte(REX_W); // cmove rax, rcx
+    emitByte(0x0F);
+    emitByte(0x44);
+    emitByte(MODRM_REG | (RAX << 3) | RCX);
+    if (!dpr.sf) {
+        emitMask(RAX);
+    }
+    emitStore(RAX, regOffset(dpr.rd));
+    return true;
+}
+
+// udiv and sdiv, branching round the host divide where it would fault: by zero the quotient is 0,
+// and by -1 it is the negated dividend
+static bool compileDivide(struct DPR dpr)
+{
+    if (dpr.rd == ZR_SP) {
+        return true;
+    }
+    bool isSigned = (dpr.opcode == SDIV_OPCODE);
+    emitLoad(RAX, regOffset(dpr.rn));
+    emitLoad(RCX, regOffset(dpr.rm));
+    emitRegOp(dpr.sf, OP_TEST, RCX, RCX);
+    emitByte(0x75); // jnz past the zero quotient
+    uint8_t *nonzero = out++;
+    emitRegOp(false, OP_XOR, RAX, RAX);
+    emitByte(0xEB); // jmp to the store
+    uint8_t *zeroDone = out++;
+    *nonzero = out - (nonzero + 1);
+
+    uint8_t *negateDone = NULL;
+    if (isSigned) {
+        emitImmOp(dpr.sf, EXT_CMP, RCX, -1);
+        emitByte(0x75); // jne past the negation
+        uint8_t *notMinusOne = out++;
+        emitRegOp(dpr.sf, 0xF7, RAX, EXT_NEG);
+        emitByte(0xEB); // jmp to the store
+        negateDone = out++;
+        *notMinusOne = out - (notMinusOne + 1);
+        if (dpr.sf) {
+            emitByte(REX_W); // cqo
+        }
+        emitByte(0x99); // cdq
+    } else {
+        emitRegOp(false, OP_XOR, RDX, RDX);
+    }
+    emitRegOp(dpr.sf, 0xF7, RCX, isSigned ? EXT_IDIV : EXT_DIV);
+
+    *zeroDone = out - (zeroDone + 1);
+    if (negateDone != NULL) {
+        *negateDone = out - (negateDone + 1);
+    }
+    emitStore(RAX, regOffset(dpr.rd)); // 32-bit operations clear the upper half
+    return true;
+}
+
+// 1.5 Data Processing Instruction (Register)
+static bool compileDPR(struct DPR dpr, bool needFlags)
+{
+    if (dpr.m == 1 && dpr.opr == DPR_SELECT) {
+        return compileSelect(dpr);
+    }
+    if (dpr.m == 1 && dpr.opr == DPR_DIVIDE) {
+        return compileDivide(dpr);
+    }
+    int32_t rd = regOffset(dpr.rd);
+    bool written;
+
+    emitLoad(RCX, regOffset(dpr.rm));
+    emitLoad(RAX, (dpr.rm != ZR_SP) ? regOffset(dpr.rn) : OFFSET(ZR));
+    if (!dpr.sf) {
+        emitMask(RCX);
+        emitMask(RAX);
+    }
+
+    if (dpr.m == 0) {
+        int amount = dpr.operand % (dpr.sf ? MODE64 : MODE32);
+        if (amount != 0) {
+            emitShift(dpr.sf, shiftExtension[dpr.shift], RCX, amount);
+        }
+        emitMov(RDI, RAX);
+        emitMov(RSI, RCX);
+
+        bool setFlags;
+        if (dpr.armOrLog == 1) { // Arithmetic
+            bool isAdd = (dpr.opc == ADD || dpr.opc == ADD_SETFLAGS);
+            setFlags = (dpr.opc == ADD_SETFLAGS || dpr.opc == SUB_SETFLAGS);
+            emitRegOp(true, isAdd ? OP_ADD : OP_SUB, RAX, RCX);
+            if (setFlags && needFlags) {
+                emitRecordFlags(isAdd ? FLAGS_ADD : FLAGS_SUB, dpr.sf);
+            }
+        } else { // Logical
+            if (dpr.n == 1) {
+                emitRegOp(true, 0xF7, RSI, EXT_NOT);
+                emitMov(RCX, RSI);
+            }
+            setFlags = (dpr.opc == BITWISE_AND_SETFLAGS);
+            uint8_t opcode = (dpr.opc == BITWISE_OR) ? OP_OR
+                           : (dpr.opc == BITWISE_XOR) ? OP_XOR
+                           : OP_AND;
+            emitRegOp(true, opcode, RAX, RCX);
+            if (setFlags && needFlags) {
+                emitRecordFlags(FLAGS_AND, dpr.sf);
+            }
+        }
+        written = !(setFlags && dpr.rd == ZR_SP);
+        if (written) {
+            if (!dpr.sf) {
+                emitMask(RAX);
+            }
+            emitStore(RAX, rd);
+        }
+    } else { // Multiply
+        written = (dpr.rd != ZR_SP);
+        if (written) {
+            emitLoad(RDX, regOffset(dpr.ra));
+            emitByte(REX_W); // imul rax, rcx
+            emitByte(0x0F);
+            emitByte(0xAF);
+            emitByte(MODRM_REG | (RAX << 3) | RCX);
+            emitRegOp(true, (dpr.x == 0) ? OP_ADD : OP_SUB, RDX, RAX);
+            if (!dpr.sf) {
+                emitMask(RDX);
+            }
+            emitStore(RDX, rd);
+        }
+    }
+
+    if (!written && !dpr.sf) {
+        emitMaskState(rd);
+    }
+    return true;
+}
+
+// Leave the block after the store at index if it overwrote translated code
+static void emitExitAfterStore(int64_t pc, int index)
+{
+    emitLoadByte(RAX, OFFSET(translatedCodeWritten));
+    emitRegOp(false, OP_TEST, RAX, RAX);
+    emitByte(0x74); // jz past the exit
+    uint8_t *skip = out++;
+    int synced = retiredSynced;
+    emitRetire(index + 1);
+    retiredSynced = synced;
+    emitSetPC(pc + INSTR_BYTES);
+    emitReturn();
+    *skip = out - (skip + 1);
+}
+
+// 1.7 Single Data Transfer Instruction
+static bool compileSDT(struct SDT sdt, int64_t pc, int index)
+{
+    emitRetire(index); // Devices see the instruction count
+    int32_t rt = regOffset(sdt.rt);
+    if (!sdt.sf) {
+        emitMaskState(rt);
+    }
+
+    // Target address in RAX
+    if (sdt.mode == 1) { // Single Data Transfer
+        int32_t xn = spOffset(sdt.xn);
+        emitLoad(RAX, xn);
+        if (sdt.u == 1) { // Unsigned Immediate Offset
+            uint16_t uoffset = sdt.imm12 * ((sdt.sf) ? MODE64_BYTES : MODE32_BYTES);
+            emitImmOp(true, EXT_ADD, RAX, uoffset);
+        } else if (sdt.offmode == 0) { // Pre/Post - Index
+            if (sdt.i) {
+                emitImmOp(true, EXT_ADD, RAX, sdt.simm9);
+            }
+            emitAddState(xn, sdt.simm9);
+        } else { // Register Offset
+            emitMemOp(true, OP_ADD_LOAD, RAX, (sdt.xn == ZR_SP) ? OFFSET(SP) : regOffset(sdt.xm));
+        }
+    } else { // Load Literal
+        emitMovImm(RAX, pc + ((int64_t)sdt.simm19) * INSTR_BYTES);
+    }
+    emitMov(RDI, RAX);
+    emitMovImm(RDX, sdt.sf);
+
+    if (sdt.mode == 0 || sdt.l == 1) { // Load
+        emitMemOp(true, OP_LEA, RSI, rt);
+        emitCall((uintptr_t)loadFromMemory);
+        return true;
+    }
+
+    // Store, leaving the block if it overwrote translated code
+    emitLoad(RSI, rt);
+    emitCall((uintptr_t)storeToMemory);
+    emitExitAfterStore(pc, index);
+    return true;
+}
+
+// Load and Store Pair, through the interpreter's transfer
+static bool compilePair(const struct SDT *sdt, int64_t pc, int index)
+{
+    emitRetire(index);
+    emitMovImm(RDI, (uintptr_t)sdt);
+    emitCall((uintptr_t)transferPair);
+    if (sdt->l == 0) {
+        emitExitAfterStore(pc, index);
+    }
+    return true;
+}
+
+// 1.8 Branch Instruction
+static bool compileB(struct B b, int64_t pc)
+{
+    switch (b.type) {
+        case BRANCH_UNCONDITIONAL:
+            emitSetPC(pc + ((int64_t)b.simm26) * INSTR_BYTES);
+            return true;
+        case BRANCH_LINK:
+            emitMovImm(RAX, pc + INSTR_BYTES);
+            emitStore(RAX, regOffset(LINK_REGISTER));
+            emitSetPC(pc + ((int64_t)b.simm26) * INSTR_BYTES);
+            return true;
+        case BRANCH_CONDITIONAL:
+            if (!emitCondition(b.cond)) {
+                return false;
+            }
+            emitMovImm(RCX, pc + INSTR_BYTES);
+            emitMovImm(RDX, pc + ((int64_t)b.simm19) * INSTR_BYTES);
+            emitByte(0x84); // test al, al
+            emitByte(0xC0);
+            emitByte(REX_W); // cmovne rcx, rdx
+            emitByte(0x0F);
+            emitByte(0x45);
+            emitByte(MODRM_REG | (RCX << 3) | RDX);
+            emitStore(RCX, OFFSET(PC));
+            return true;
+        case BRANCH_COMPARE:
+        case BRANCH_TEST:
+            // ZF set when the register, or the tested bit of it, is zero
+            emitLoad(RAX, regOffset(b.rt));
+            if (b.type == BRANCH_COMPARE) {
+                emitRegOp(b.sf, OP_TEST, RAX, RAX);
+            } else {
+                if (b.sf * 32 + b.b40 > 0) {
+                    emitShift(true, EXT_SHR, RAX, b.sf * 32 + b.b40);
+                }
+                emitByte(0xA8); // test al, 1
+                emitByte(0x01);
+            }
+            emitMovImm(RCX, pc + INSTR_BYTES);
+            emitMovImm(RDX, pc + ((int64_t)b.simm) * INSTR_BYTES);
+            emitByte(REX_W); // cmove or cmovne rcx, rdx
+            emitByte(0x0F);
+            emitByte(b.nonzero ? 0x45 : 0x44);
+            emitByte(MODRM_REG | (RCX << 3) | RDX);
+            emitStore(RCX, OFFSET(PC));
+            return true;
+        case BRANCH_REGISTER: // The target is read before blr links
+            if (b.opc > RET_OPC) {
+                return false;
+            }
+            emitLoad(RAX, regOffset(b.xn));
+            if (b.opc == BLR_OPC) {
+                emitMovImm(RCX, pc + INSTR_BYTES);
+                emitStore(RCX, regOffset(LINK_REGISTER));
+            }
+            emitStore(RAX, OFFSET(PC));
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool compileInstruction(Instruction *instruction, int64_t pc, int index, bool needFlags)
+{
+    switch (instruction->instructionType) {
+        case isDPI:
+            return compileDPI(instruction->dpi, needFlags);
+        case isDPR:
+            return compileDPR(instruction->dpr, needFlags);
+        case isSDT:
+            if (instruction->sdt.pair) {
+                return compilePair(&instruction->sdt, pc, index);
+            }
+            return compileSDT(instruction->sdt, pc, index);
+        case isB:
+            return compileB(instruction->b, pc);
+        default:
+            return false;
+    }
+}
+
+//
+// Translation Buffer
+//
+// Map the executable buffer the translated blocks are written to
+bool initializeJit(void)
+{
+    struct Jit *jit = malloc(sizeof(struct Jit));
+    if (jit == NULL) {
+        return false;
+    }
+    void *buffer = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        free(jit);
+        return false;
+    }
+    jit->buffer = buffer;
+    jit->used = 0;
+    state->jit = jit;
+    return true;
+}
+
+// Translate a block to host code, NULL once the buffer is full
+CompiledBlock compileBlock(Block *block)
+{
+    struct Jit *jit = state->jit;
+    if (jit == NULL || jit->used + MAX_BLOCK_CODE > JIT_BUFFER_SIZE) {
+        return NULL;
+    }
+
+    // Only the last flag-setting instruction before a read needs to compute the flags
+    bool needFlags[MAX_BLOCK_LENGTH];
+    bool live = true;
+    for (int i = block->length - 1; i >= 0; i--) {
+        needFlags[i] = live;
+        if (setsFlags(&block->instructions[i])) {
+            live = false;
+        }
+        if (readsFlags(&block->instructions[i]) || leavesEarly(&block->instructions[i])) {
+            live = true;
+        }
+    }
+
+    uint8_t *entry = jit->buffer + jit->used;
+    out = entry;
+    retiredSynced = 0;
+    emitByte(0x53); // push rbx
+    emitMov(RBX, RDI);
+
+    for (int i = 0; i < block->length; i++) {
+        Instruction *instruction = &block->instructions[i];
+        int64_t pc = block->start + i * INSTR_BYTES;
+        if (!compileInstruction(instruction, pc, i, needFlags[i])) {
+            emitFallback(instruction, pc, i);
+        }
+    }
+    emitRetire(block->length);
+    // A final branch has set the PC already
+    if (block->length == 0 || block->instructions[block->length - 1].instructionType != isB) {
+        emitSetPC(block->start + block->length * INSTR_BYTES);
+    }
+    emitReturn();
+    jit->used += out - entry;
+
+    CompiledBlock code;
+    memcpy(&code, &entry, sizeof(code));
+    return code;
+}
+
+// Discard every translated block
+void resetJit(void)
+{
+    if (state->jit != NULL) {
+        state->jit->used = 0;
+    }
+}
+
+void freeJit(void)
+{
+    if (state->jit != NULL) {
+        munmap(state->jit->buffer, JIT_BUFFER_SIZE);
+        free(state->jit);
+        state->jit = NULL;
+    }
+}
+
+#else
+
+// Host code generation is only available on x86-64 hosts
+bool initializeJit(void)
+{
+    return false;
+}
+
+CompiledBlock compileBlock(Block *block)
+{
+    return NULL;
+}
+
+void resetJit(void)
+{
+}
+
+void freeJit(void)
+{
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Translation of hot basic blocks into x86-64 host code
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdbool.h>
+#include "block.h"
+
+#define JIT_THRESHOLD 16 // interpreted executions before a block is translated
+
+
+// Prototypes
+extern bool initializeJit(void);
+extern CompiledBlock compileBlock(Block *block);
+extern void resetJit(void);
+extern void freeJit(void);
+
+#endif
@@ -0,0 +1,643 @@
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "block.h"
+#include "cache.h"
+#include "checkpoint.h"
+#include "constants.h"
+#include "datatypes_em.h"
+#include "decoders.h"
+#include "device.h"
+#include "dispatch.h"
+#include "execute.h"
+#include "format.h"
+#include "gpio.h"
+#include "io.h"
+#include "jit.h"
+#include "libemulate.h"
+#include "memory.h"
+#include "profile.h"
+#include "sample.h"
+#include "snapshot.h"
+#include "status.h"
+#include "structs.h"
+#include "timing.h"
+#include "trace.h"
+#include "utils_em.h"
+
+#define DUMP_BUFFER_SIZE (256 * 1024)
+#define MAX_DUMP_LINE 64
+
+
+struct Emulator {
+    struct EmulatorState state;
+    EmulatorOptions options;
+    bool halted;          // the loaded program reached the halt instruction
+    EmulateStatus error;  // EMULATE_OK until an error stops the loaded program
+    const char *message;  // description of the error
+};
+
+// Emulator every module works on, set by each library call on its thread
+_Thread_local struct EmulatorState *state = NULL;
+
+// Errors raised inside a library call return here
+static _Thread_local jmp_buf *errorHandler = NULL;
+static _Thread_local Emulator *current = NULL;
+
+// Stop the current library call with status, exiting if no call is active
+void raiseError(EmulateStatus status, const char *message)
+{
+    if (errorHandler == NULL) {
+        fprintf(stderr, "%s\n", message);
+        exit(EXIT_FAILURE);
+    }
+    current->error = status;
+    current->message = message;
+    longjmp(*errorHandler, 1);
+}
+
+// Make emulator the target of the modules, errors returning to handler
+static void enter(Emulator *emulator, jmp_buf *handler)
+{
+    state = &emulator->state;
+    current = emulator;
+    errorHandler = handler;
+}
+
+static EmulateStatus leave(EmulateStatus status)
+{
+    errorHandler = NULL;
+    return status;
+}
+
+//
+// Engines
+//
+// Run until the halt instruction or limit, decoding every instruction on each step
+static bool runUncached(uint64_t limit)
+{
+    Instruction instruction = { .instructionType = isDPI };
+    uint32_t instr;
+    while ((instr = fetch(state->PC)) != HALT_INSTR) {
+        if (state->retired >= limit) {
+            return false;
+        }
+        if (!isDecodable(instr)) {
+            raiseError(EMULATE_ERROR_UNDEFINED, "Undefined instruction.");
+        }
+        int decodeError = decode(&instr, &instruction, getBits);
+        checkError(decodeError);
+
+        uint64_t pc = state->PC;
+        int executeError = execute(instruction);
+        checkError(executeError);
+        state->retired++;
+        countInstruction(pc, state->PC);
+        trackBranch(&instruction);
+    }
+    return true;
+}
+
+// Run until the halt instruction or limit, reusing decoded instructions and their handlers from the cache
+static bool runCached(uint64_t limit)
+{
+    while (true) {
+        DecodedInstr *decoded = fetchDecoded(state->PC);
+        if (decoded->halt) {
+            return true;
+        }
+        if (state->retired >= limit) {
+            return false;
+        }
+        if (decoded->undefined) {
+            raiseError(EMULATE_ERROR_UNDEFINED, "Undefined instruction.");
+        }
+        uint64_t pc = state->PC;
+        executeHandlers(&decoded->instruction, &decoded->handler, 1);
+        countInstruction(pc, state->PC);
+        trackBranch(&decoded->instruction);
+    }
+}
+
+// Run until the halt instruction or limit like runCached, recording every instruction in the trace
+// and the timing model
+static bool runTraced(uint64_t limit)
+{
+    while (true) {
+        DecodedInstr *decoded = fetchDecoded(state->PC);
+        if (decoded->halt) {
+            return true;
+        }
+        if (state->retired >= limit) {
+            return false;
+        }
+        if (decoded->undefined) {
+            raiseError(EMULATE_ERROR_UNDEFINED, "Undefined instruction.");
+        }
+        uint64_t pc = state->PC;
+        uint64_t address = (state->trace != NULL) ? accessAddress(&decoded->instruction) : 0;
+        executeHandlers(&decoded->instruction, &decoded->handler, 1);
+        if (state->trace != NULL) {
+            traceInstruction(pc, &decoded->instruction, address);
+        }
+        timeInstruction(pc, &decoded->instruction, state->PC);
+        countInstruction(pc, state->PC);
+        trackBranch(&decoded->instruction);
+    }
+}
+
+// Run until the halt instruction or limit with the engine chosen by options
+static bool runEngine(const EmulatorOptions *options, uint64_t limit)
+{
+    if (state->trace != NULL || state->timing != NULL) {
+        return runTraced(limit);
+    } else if (!options->decodeCache) {
+        return runUncached(limit);
+    } else if (!options->blockCache) {
+        return runCached(limit);
+    }
+    return runBlocks(options->jit, limit);
+}
+
+// Run until the halt instruction or limit, stopping for each checkpoint on the way
+static bool runTo(const EmulatorOptions *options, uint64_t limit)
+{
+    while (true) {
+        uint64_t due = nextCheckpoint();
+        if (due <= state->retired) {
+            takeCheckpoint();
+            due = nextCheckpoint();
+        }
+        if (runEngine(options, (due < limit) ? due : limit)) {
+            return true;
+        }
+        if (state->retired >= limit) {
+            return false;
+        }
+    }
+}
+
+// Step to end, the retired count after the last store to addr on the way, UINT64_MAX if there is none
+static uint64_t findLastWrite(uint64_t addr, uint64_t end)
+{
+    uint64_t found = UINT64_MAX;
+    while (state->retired < end) {
+        DecodedInstr *decoded = fetchDecoded(state->PC);
+        if (decoded->halt || decoded->undefined) {
+            break;
+        }
+        const Instruction *instruction = &decoded->instruction;
+        bool hit = false;
+        if (instruction->instructionType == isSDT && instruction->sdt.mode && !instruction->sdt.l) {
+            uint64_t bytes = (instruction->sdt.sf ? MODE64_BYTES : MODE32_BYTES) * (instruction->sdt.pair ? 2 : 1);
+            hit = addr - accessAddress(instruction) < bytes;
+        }
+        executeHandlers(instruction, &decoded->handler, 1);
+        if (hit) {
+            found = state->retired;
+        }
+    }
+    return found;
+}
+
+// Return to the checkpoint, the translated code no longer matching the memory
+static void returnTo(Emulator *emulator, int index)
+{
+    restoreCheckpoint(index);
+    flushBlocks();
+    clearDecodeCache();
+    emulator->halted = false;
+    emulator->error = EMULATE_OK;
+    emulator->message = NULL;
+}
+
+//
+// Library Calls
+//
+// New emulator with an empty memory, NULL if it could not be allocated
+Emulator *emulatorCreate(const EmulatorOptions *options)
+{
+    Emulator *emulator = calloc(1, sizeof(Emulator));
+    if (emulator == NULL) {
+        return NULL;
+    }
+    emulator->options = *options;
+    emulator->error = EMULATE_ERROR_EMPTY_PROGRAM;
+    emulator->message = "No program is loaded.";
+
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        leave(EMULATE_ERROR_OUT_OF_MEMORY);
+        emulatorDestroy(emulator);
+        return NULL;
+    }
+    enter(emulator, &handler);
+    state->memory = createMemory();
+    if (state->memory == NULL) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the memory.");
+    }
+    initializeGpio(options->gpioLog);
+    if (options->jit && !initializeJit()) {
+        emulator->options.jit = false;
+    }
+    if (options->profile && !initializeProfile()) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the profile.");
+    }
+    if (options->timing && !initializeTiming()) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the timing model.");
+    }
+    if (options->trace != NULL && !startTrace(options->trace)) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to start the trace.");
+    }
+    if (options->checkpointInterval > 0
+        && !initializeCheckpoints(options->checkpointInterval, options->checkpointBudget)) {
+        raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the checkpoints.");
+    }
+    if (options->samples != NULL) {
+        if (!initializeCallStack()) {
+            raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate the call stack.");
+        }
+        fflush(options->samples);
+        if (options->sampleInterval == 0 || !writeSampleHeader(fileno(options->samples), options->sampleInterval)) {
+            emulator->options.samples = NULL;
+        }
+    }
+    leave(EMULATE_OK);
+    return emulator;
+}
+
+// Zero the registers and memory of the current emulator; only what the previous program
+// touched is cleared, so reloading costs little
+static void reset(Emulator *emulator)
+{
+    flushBlocks();
+    clearCheckpoints();
+    clearProfile();
+    clearTiming();
+    clearCallStack();
+    restartTrace();
+    clearDecodeCache();
+    clearMemory();
+    resetDevices();
+    struct EmulatorState initial = {
+        .pstate.Z = true,
+        .memory = state->memory,
+        .decodeCache = state->decodeCache,
+        .blockCache = state->blockCache,
+        .jit = state->jit,
+        .devices = state->devices,
+        .profile = state->profile,
+        .callStack = state->callStack,
+        .trace = state->trace,
+        .checkpoints = state->checkpoints,
+        .timing = state->timing
+    };
+    *state = initial;
+    emulator->halted = false;
+    emulator->error = EMULATE_OK;
+    emulator->message = NULL;
+}
+
+// Reset the emulator and copy program to address 0
+EmulateStatus emulatorLoad(Emulator *emulator, const uint8_t *program, size_t size)
+{
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        return leave(emulator->error);
+    }
+    enter(emulator, &handler);
+    reset(emulator);
+    if (size == 0) {
+        raiseError(EMULATE_ERROR_EMPTY_PROGRAM, "The program is empty.");
+    }
+    copyToMemory(0, program, size);
+    return leave(EMULATE_OK);
+}
+
+// Run the loaded program for at most budget instructions, EMULATOR_UNLIMITED to run
+// until the halt instruction; returns EMULATE_OK once halted
+EmulateStatus emulatorRun(Emulator *emulator, uint64_t budget)
+{
+    if (emulator->error != EMULATE_OK) {
+        return emulator->error;
+    }
+    if (emulator->halted) {
+        return EMULATE_OK;
+    }
+
+    const EmulatorOptions *options = &emulator->options;
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        if (options->samples != NULL) {
+            stopSampling();
+        }
+        return leave(emulator->error);
+    }
+    enter(emulator, &handler);
+    if (options->samples != NULL && !startSampling(fileno(options->samples), options->sampleInterval)) {
+        stopSampling(); // run unsampled
+    }
+    uint64_t limit = UINT64_MAX;
+    if (budget != EMULATOR_UNLIMITED && budget < UINT64_MAX - state->retired) {
+        limit = state->retired + budget;
+    }
+
+    emulator->halted = runTo(options, limit);
+    if (options->samples != NULL) {
+        stopSampling();
+    }
+    return leave(emulator->halted ? EMULATE_OK : EMULATE_BUDGET_EXHAUSTED);
+}
+
+// Move to the state after retired instructions, running backwards from the newest checkpoint
+// at or before it if needed; returns like emulatorRun
+EmulateStatus emulatorSeek(Emulator *emulator, uint64_t retired)
+{
+    if (retired >= emulator->state.retired) {
+        return (retired > emulator->state.retired) ? emulatorRun(emulator, retired - emulator->state.retired)
+                                                   : EMULATE_OK;
+    }
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        return leave(emulator->error);
+    }
+    enter(emulator, &handler);
+    int index = findCheckpoint(retired);
+    if (index < 0) {
+        return leave(EMULATE_ERROR_OUT_OF_HISTORY);
+    }
+    returnTo(emulator, index);
+    emulator->halted = runTo(&emulator->options, retired);
+    return leave(emulator->halted ? EMULATE_OK : EMULATE_BUDGET_EXHAUSTED);
+}
+
+// Move back to just after the last store to the byte at addr, searching the checkpoints
+// newest first and returning like emulatorRun; EMULATE_ERROR_OUT_OF_HISTORY, the state
+// unchanged, if none wrote it
+EmulateStatus emulatorLastWrite(Emulator *emulator, uint64_t addr)
+{
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        return leave(emulator->error);
+    }
+    enter(emulator, &handler);
+    uint64_t now = state->retired;
+    EmulateStatus error = emulator->error;
+    const char *message = emulator->message;
+    uint64_t end = now;
+    for (int index = findCheckpoint(now); index >= 0; index--) {
+        uint64_t start = checkpointRetired(index);
+        if (start == end) {
+            continue;
+        }
+        returnTo(emulator, index);
+        uint64_t found = findLastWrite(addr, end);
+        if (found != UINT64_MAX) {
+            returnTo(emulator, index);
+            emulator->halted = runTo(&emulator->options, found);
+            return leave(emulator->halted ? EMULATE_OK : EMULATE_BUDGET_EXHAUSTED);
+        }
+        end = start;
+    }
+    if (end != now) {
+        // Replay the history searched back to where it started
+        emulator->halted = runTo(&emulator->options, now);
+        emulator->error = error;
+        emulator->message = message;
+    }
+    return leave(EMULATE_ERROR_OUT_OF_HISTORY);
+}
+
+// Save the registers, flags and non-zero memory to file, for emulatorRestore to continue from
+EmulateStatus emulatorSnapshot(Emulator *emulator, FILE *file)
+{
+    state = &emulator->state;
+    return writeSnapshot(file) ? EMULATE_OK : EMULATE_ERROR_OUT_OF_MEMORY;
+}
+
+// Reset the emulator to the state saved in snapshot, which may be a mapped snapshot file
+EmulateStatus emulatorRestore(Emulator *emulator, const uint8_t *snapshot, size_t size)
+{
+    jmp_buf handler;
+    if (setjmp(handler) != 0) {
+        return leave(emulator->error);
+    }
+    enter(emulator, &handler);
+    reset(emulator);
+    readSnapshot(snapshot, size);
+    return leave(EMULATE_OK);
+}
+
+// Assembly text of the word at addr
+void emulatorDisassemble(Emulator *emulator, uint64_t addr, char *text, size_t size)
+{
+    state = &emulator->state;
+    formatWord(readMemory(addr, INSTR_BYTES), addr, text, size);
+}
+
+// Make emulator the target of the library modules for code working on its state directly,
+// such as programs translated by aot-translate; errors then exit with their message
+struct EmulatorState *emulatorEnter(Emulator *emulator)
+{
+    state = &emulator->state;
+    current = emulator;
+    errorHandler = NULL;
+    return state;
+}
+
+int64_t emulatorRegister(Emulator *emulator, int reg)
+{
+    return (reg >= 0 && reg < NUM_OF_REGISTERS) ? emulator->state.R[reg] : 0;
+}
+
+int64_t emulatorPC(Emulator *emulator)
+{
+    return emulator->state.PC;
+}
+
+uint64_t emulatorRetired(Emulator *emulator)
+{
+    return emulator->state.retired;
+}
+
+// NZCV as a mask of the EMULATOR_FLAG bits
+int emulatorFlags(Emulator *emulator)
+{
+    state = &emulator->state;
+    evaluateFlags();
+    return (state->pstate.N ? EMULATOR_FLAG_N : 0) | (state->pstate.Z ? EMULATOR_FLAG_Z : 0)
+         | (state->pstate.C ? EMULATOR_FLAG_C : 0) | (state->pstate.V ? EMULATOR_FLAG_V : 0);
+}
+
+// Little-endian value of 1 to 8 bytes at addr, 0 for any other size
+uint64_t emulatorReadMemory(Emulator *emulator, uint64_t addr, int bytes)
+{
+    state = &emulator->state;
+    if (bytes < 1 || bytes > MODE64_BYTES) {
+        return 0;
+    }
+    // Memory is read a word or doubleword at a time, the bytes past the value masked off
+    uint64_t value = readMemory(addr, (bytes <= MODE32_BYTES) ? MODE32_BYTES : MODE64_BYTES);
+    return (bytes < MODE64_BYTES) ? value & ((1ULL << (BYTE_SIZE * bytes)) - 1) : value;
+}
+
+// Executions of every instruction since the program was loaded, hottest first
+void emulatorWriteProfile(Emulator *emulator, FILE *file)
+{
+    state = &emulator->state;
+    profileBlocks();
+    writeProfile(file);
+}
+
+// Totals of the executed instructions, false unless the emulator was created profiling
+bool emulatorStats(Emulator *emulator, EmulatorStats *stats)
+{
+    state = &emulator->state;
+    profileBlocks();
+    return summarizeProfile(stats);
+}
+
+// Estimated cycles of the instructions run, false unless the emulator was created timing
+bool emulatorTiming(Emulator *emulator, EmulatorTiming *timing)
+{
+    state = &emulator->state;
+    return summarizeTiming(timing);
+}
+
+// Description of the error that stopped the loaded program, NULL if there is none
+const char *emulatorErrorMessage(Emulator *emulator)
+{
+    return emulator->message;
+}
+
+void emulatorDestroy(Emulator *emulator)
+{
+    if (emulator == NULL) {
+        return;
+    }
+    state = &emulator->state;
+    stopTrace();
+    freeCheckpoints();
+    freeBlocks();
+    freeJit();
+    freeDecodeCache();
+    freeDevices();
+    freeProfile();
+    freeTiming();
+    freeCallStack();
+    if (state->memory != NULL) {
+        freeMemory();
+    }
+    state = NULL;
+    free(emulator);
+}
+
+//
+// Final State
+//
+// Memory dump lines are formatted here and written out in large chunks
+typedef struct {
+    FILE *file;
+    size_t used;
+    char data[DUMP_BUFFER_SIZE];
+} DumpBuffer;
+
+static void flushDump(DumpBuffer *buffer)
+{
+    fwrite(buffer->data, 1, buffer->used, buffer->file);
+    buffer->used = 0;
+}
+
+// Append value in lower case hex, zero padded to at least digits
+static char *appendHex(char *out, uint64_t value, int digits)
+{
+    char reversed[2 * sizeof(uint64_t)];
+    int length = 0;
+    do {
+        reversed[length++] = "0123456789abcdef"[value % 16];
+        value /= 16;
+    } while (value != 0);
+    while (length < digits) {
+        reversed[length++] = '0';
+    }
+    while (length > 0) {
+        *out++ = reversed[--length];
+    }
+    return out;
+}
+
+// Little-endian word at offset in the page
+static uint32_t pageWord(const uint8_t *page, int offset)
+{
+    uint32_t binInstr = 0;
+    for (int i = 0; i < INSTR_BYTES; i++) {
+        binInstr |= ((uint32_t)page[offset + i]) << (BYTE_SIZE * i);
+    }
+    return binInstr;
+}
+
+// Append "0x%08lx : %08x\n" for every non-zero word of the page
+static void dumpPage(uint64_t addr, const uint8_t *page, void *context)
+{
+    DumpBuffer *buffer = context;
+    for (int offset = 0; offset < PAGE_SIZE; offset += INSTR_BYTES) {
+        uint32_t binInstr = pageWord(page, offset);
+        if (binInstr == 0) {
+            continue;
+        }
+        if (buffer->used > DUMP_BUFFER_SIZE - MAX_DUMP_LINE) {
+            flushDump(buffer);
+        }
+        char *out = buffer->data + buffer->used;
+        *out++ = '0';
+        *out++ = 'x';
+        out = appendHex(out, addr + offset, 8);
+        memcpy(out, " : ", 3);
+        out = appendHex(out + 3, binInstr, 8);
+        *out++ = '\n';
+        buffer->used = out - buffer->data;
+    }
+}
+
+// dumpPage a line at a time, when there is no memory for the buffer
+static void printPage(uint64_t addr, const uint8_t *page, void *context)
+{
+    for (int offset = 0; offset < PAGE_SIZE; offset += INSTR_BYTES) {
+        uint32_t binInstr = pageWord(page, offset);
+        if (binInstr != 0) {
+            fprintf(context, "0x%08lx : %08x\n", addr + offset, binInstr);
+        }
+    }
+}
+
+// Write the registers, flags and non-zero memory in the format of the reference emulator
+void emulatorWriteState(Emulator *emulator, FILE *file)
+{
+    int flags = emulatorFlags(emulator);
+    fprintf(file, "Registers:\n");
+    for (int i = 0; i < NUM_OF_REGISTERS; i++) {
+        fprintf(file, "X%d%d    = %016lx\n", i / 10, i % 10, state->R[i]);
+    }
+    fprintf(file, "PC     = %016lx\n", state->PC);
+    fprintf(file, "PSTATE : %c%c%c%c",
+            (flags & EMULATOR_FLAG_N) ? 'N' : '-',
+            (flags & EMULATOR_FLAG_Z) ? 'Z' : '-',
+            (flags & EMULATOR_FLAG_C) ? 'C' : '-',
+            (flags & EMULATOR_FLAG_V) ? 'V' : '-');
+    fprintf(file, "\nNon-Zero Memory:\n");
+
+    // Only dirty pages can hold non-zero words
+    DumpBuffer *buffer = malloc(sizeof(DumpBuffer));
+    if (buffer == NULL) {
+        forEachDirtyPage(printPage, file);
+        return;
+    }
+    buffer->file = file;
+    buffer->used = 0;
+    forEachDirtyPage(dumpPage, buffer);
+    flushDump(buffer);
+    free(buffer);
+}
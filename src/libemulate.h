@@ -0,0 +1,96 @@
+// Reentrant emulator library, each emulator owning its state, caches and devices
+
+#ifndef LIBEMULATE_H
+#define LIBEMULATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "status.h"
+
+// Bits of emulatorFlags
+#define EMULATOR_FLAG_N 8
+#define EMULATOR_FLAG_Z 4
+#define EMULATOR_FLAG_C 2
+#define EMULATOR_FLAG_V 1
+
+#define EMULATOR_UNLIMITED 0 // budget of a run until the halt instruction
+#define EMULATOR_TEXT_SIZE 48 // room for the text of emulatorDisassemble
+
+struct EmulatorState;
+
+// Opaque emulator context; an emulator may only be used by one thread at a time
+typedef struct Emulator Emulator;
+
+typedef struct {
+    bool decodeCache; // reuse decoded instructions
+    bool blockCache;  // run chained basic blocks, needs the decode cache
+    bool jit;         // translate hot blocks to host code, needs the block cache
+    bool profile;     // count executions per instruction for emulatorWriteProfile and emulatorStats
+    FILE *gpioLog;    // GPIO pin transitions are logged here, NULL to not log them
+    FILE *samples;    // the PC and call stack are sampled here while running, NULL to not sample
+    uint32_t sampleInterval; // microseconds of CPU time between samples
+    FILE *trace;      // every retired instruction is recorded here, NULL to not trace
+    uint64_t checkpointInterval; // instructions between checkpoints for emulatorSeek, 0 to not checkpoint
+    size_t checkpointBudget;     // bytes of saved memory kept before the oldest checkpoints are dropped
+    bool timing;      // estimate the cycles of a Cortex-A53 class core for emulatorTiming, one instruction at a time
+} EmulatorOptions;
+
+// Totals since the program was loaded, the instructions classified as they are in memory now
+typedef struct {
+    uint64_t retired;
+    uint64_t dpiArithmetic;  // add, sub and their flag-setting forms with an immediate
+    uint64_t wideMove;       // movn, movz, movk
+    uint64_t dprArithmetic;  // add, sub and their flag-setting forms with a shifted register
+    uint64_t dprLogical;     // and, bic, orr, orn, eor, eon, ands, bics
+    uint64_t multiply;       // madd, msub
+    uint64_t conditionalSelect; // csel, csinc, csinv, csneg
+    uint64_t divide;         // udiv, sdiv
+    uint64_t loadLiteral;    // ldr with a PC-relative literal
+    uint64_t unsignedOffset; // ldr and str by addressing mode
+    uint64_t preIndex;
+    uint64_t postIndex;
+    uint64_t registerOffset;
+    uint64_t pairs;          // ldp and stp
+    uint64_t branchUnconditional;
+    uint64_t branchConditional;
+    uint64_t branchRegister;
+    uint64_t takenBranches;
+    uint64_t bytesLoaded;
+    uint64_t bytesStored;
+} EmulatorStats;
+
+// Estimate of the instructions since the program was loaded running on an in-order dual-issue core
+typedef struct {
+    uint64_t instructions;
+    uint64_t cycles;
+    uint64_t dualIssued;    // instructions issued in the same cycle as the one before them
+    uint64_t loadUseStalls; // cycles spent waiting for a loaded register
+    uint64_t mispredicts;   // conditional and register branches predicted wrong
+} EmulatorTiming;
+
+
+// Prototypes
+extern Emulator *emulatorCreate(const EmulatorOptions *options);
+extern EmulateStatus emulatorLoad(Emulator *emulator, const uint8_t *program, size_t size);
+extern EmulateStatus emulatorRun(Emulator *emulator, uint64_t budget);
+extern EmulateStatus emulatorSnapshot(Emulator *emulator, FILE *file);
+extern EmulateStatus emulatorRestore(Emulator *emulator, const uint8_t *snapshot, size_t size);
+extern EmulateStatus emulatorSeek(Emulator *emulator, uint64_t retired);
+extern EmulateStatus emulatorLastWrite(Emulator *emulator, uint64_t addr);
+extern void emulatorDisassemble(Emulator *emulator, uint64_t addr, char *text, size_t size);
+extern struct EmulatorState *emulatorEnter(Emulator *emulator);
+extern int64_t emulatorRegister(Emulator *emulator, int reg);
+extern int64_t emulatorPC(Emulator *emulator);
+extern uint64_t emulatorRetired(Emulator *emulator);
+extern int emulatorFlags(Emulator *emulator);
+extern uint64_t emulatorReadMemory(Emulator *emulator, uint64_t addr, int bytes);
+extern void emulatorWriteState(Emulator *emulator, FILE *file);
+extern void emulatorWriteProfile(Emulator *emulator, FILE *file);
+extern bool emulatorStats(Emulator *emulator, EmulatorStats *stats);
+extern bool emulatorTiming(Emulator *emulator, EmulatorTiming *timing);
+extern const char *emulatorErrorMessage(Emulator *emulator);
+extern void emulatorDestroy(Emulator *emulator);
+
+#endif
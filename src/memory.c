@@ -0,0 +1,339 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "device.h"
+#include "memory.h"
+#include "status.h"
+
+// Hosts storing values little endian can copy them to and from memory directly
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LITTLE_ENDIAN_HOST
+#endif
+
+// Page table: a root indexed by the top 12 address bits, then 4 levels of
+// 10 bits each down to the 4KB pages
+#define ROOT_BITS 12
+#define LEVEL_BITS 10
+#define NUM_LEVELS 4
+#define ROOT_ENTRIES (1 << ROOT_BITS)
+#define LEVEL_ENTRIES (1 << LEVEL_BITS)
+#define ROOT_SHIFT (PAGE_BITS + NUM_LEVELS * LEVEL_BITS)
+
+#define TLB_ENTRIES 64 // direct mapped
+#define BITMAP_WORD_BITS 64
+
+
+extern _Thread_local struct EmulatorState *state;
+
+
+// Entries of the last level point to pages, every other entry to the next table
+typedef union Entry Entry;
+union Entry {
+    Entry *table;
+    uint8_t *page;
+};
+
+// Last level table, with a bitmap of the pages written to
+typedef struct {
+    Entry pages[LEVEL_ENTRIES]; // first, so the table is reached like any other
+    uint64_t dirty[LEVEL_ENTRIES / BITMAP_WORD_BITS];
+    uint32_t epoch[LEVEL_ENTRIES]; // protection epoch of the last write to each page
+} LeafTable;
+
+// Recently used pages by page number
+typedef struct {
+    uint64_t pageNumber;
+    uint8_t *page;  // NULL for an empty entry
+    bool writable;  // writes may skip the page table
+} TLBEntry;
+
+// Address space of one emulator
+struct Memory {
+    Entry root[ROOT_ENTRIES];
+    TLBEntry tlb[TLB_ENTRIES];
+    PageVisitor firstWrite; // called before the first write to each page in an epoch
+    void *context;
+    uint32_t epoch;
+};
+
+// Read by accesses to pages never written
+static const uint8_t zeroPage[PAGE_SIZE];
+
+static size_t tableIndex(uint64_t addr, int level)
+{
+    return (addr >> (ROOT_SHIFT - (level + 1) * LEVEL_BITS)) & (LEVEL_ENTRIES - 1);
+}
+
+// Walk the page table to the page holding addr, allocating missing tables and
+// the page itself if asked to, NULL otherwise. Pages are only allocated when
+// written to, which marks them dirty.
+static uint8_t *walk(uint64_t addr, bool allocate)
+{
+    Entry *entry = &state->memory->root[addr >> ROOT_SHIFT];
+    for (int level = 0; level < NUM_LEVELS; level++) {
+        if (entry->table == NULL) {
+            if (!allocate) {
+                return NULL;
+            }
+            entry->table = (level == NUM_LEVELS - 1) ? calloc(1, sizeof(LeafTable))
+                                                     : calloc(LEVEL_ENTRIES, sizeof(Entry));
+            if (entry->table == NULL) {
+                raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate a page table.");
+            }
+        }
+        if (level == NUM_LEVELS - 1 && allocate) {
+            LeafTable *leaf = (LeafTable *)entry->table;
+            size_t index = tableIndex(addr, level);
+            struct Memory *memory = state->memory;
+            if (memory->firstWrite != NULL && leaf->epoch[index] != memory->epoch) {
+                leaf->epoch[index] = memory->epoch;
+                const uint8_t *page = leaf->pages[index].page;
+                memory->firstWrite(addr & ~(uint64_t)(PAGE_SIZE - 1), (page != NULL) ? page : zeroPage,
+                                   memory->context);
+            }
+            if (leaf->pages[index].page == NULL) {
+                leaf->pages[index].page = calloc(PAGE_SIZE, 1);
+                if (leaf->pages[index].page == NULL) {
+                    raiseError(EMULATE_ERROR_OUT_OF_MEMORY, "Failed to allocate a page.");
+                }
+                leaf->dirty[index / BITMAP_WORD_BITS] |= (uint64_t)1 << (index % BITMAP_WORD_BITS);
+            }
+        }
+        entry = &entry->table[tableIndex(addr, level)];
+    }
+    return entry->page;
+}
+
+// Host page for addr, through the TLB, which never holds pages with devices
+static uint8_t *translate(uint64_t addr, bool write)
+{
+    uint64_t pageNumber = addr >> PAGE_BITS;
+    TLBEntry *cached = &state->memory->tlb[pageNumber % TLB_ENTRIES];
+    if (cached->page != NULL && cached->pageNumber == pageNumber && (!write || cached->writable)) {
+        return cached->page;
+    }
+
+    uint8_t *page = walk(addr, write);
+    if (page == NULL) {
+        return (uint8_t *)zeroPage; // only ever read
+    }
+    if (!deviceInPage(pageNumber << PAGE_BITS, PAGE_SIZE)) {
+        cached->pageNumber = pageNumber;
+        cached->page = page;
+        cached->writable = write || state->memory->firstWrite == NULL;
+    }
+    return page;
+}
+
+// Host address of the access when it stays within a page held by the TLB, NULL otherwise
+static inline uint8_t *lookupTLB(uint64_t addr, int bytes, bool write)
+{
+    uint64_t pageNumber = addr >> PAGE_BITS;
+    size_t offset = addr % PAGE_SIZE;
+    TLBEntry *cached = &state->memory->tlb[pageNumber % TLB_ENTRIES];
+    if (cached->pageNumber != pageNumber || cached->page == NULL || offset > PAGE_SIZE - bytes
+        || (write && !cached->writable)) {
+        return NULL;
+    }
+    return cached->page + offset;
+}
+
+static inline uint64_t loadValue(const uint8_t *data, int bytes)
+{
+#if defined(LITTLE_ENDIAN_HOST)
+    if (bytes == MODE64_BYTES) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+#else
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= ((uint64_t)data[i]) << (BYTE_SIZE * i);
+    }
+    return value;
+#endif
+}
+
+static inline void storeValue(uint8_t *data, uint64_t value, int bytes)
+{
+#if defined(LITTLE_ENDIAN_HOST)
+    if (bytes == MODE64_BYTES) {
+        memcpy(data, &value, sizeof(value));
+    } else {
+        uint32_t word = value;
+        memcpy(data, &word, sizeof(word));
+    }
+#else
+    for (int i = 0; i < bytes; i++) {
+        data[i] = (value >> (BYTE_SIZE * i)) & MASK8;
+    }
+#endif
+}
+
+// Accesses missing the TLB: devices, new pages and accesses crossing pages
+static uint64_t readSlow(uint64_t addr, int bytes)
+{
+    const Device *device = findDevice(addr);
+    if (device != NULL) {
+        return device->read(device->context, addr - device->base, bytes);
+    }
+
+    size_t offset = addr % PAGE_SIZE;
+    if (offset > PAGE_SIZE - bytes) { // Crosses into the next page
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= ((uint64_t)translate(addr + i, false)[(addr + i) % PAGE_SIZE]) << (BYTE_SIZE * i);
+        }
+        return value;
+    }
+    return loadValue(translate(addr, false) + offset, bytes);
+}
+
+static void writeSlow(uint64_t addr, uint64_t value, int bytes)
+{
+    const Device *device = findDevice(addr);
+    if (device != NULL) {
+        device->write(device->context, addr - device->base, value, bytes);
+        return;
+    }
+
+    size_t offset = addr % PAGE_SIZE;
+    if (offset > PAGE_SIZE - bytes) { // Crosses into the next page
+        for (int i = 0; i < bytes; i++) {
+            translate(addr + i, true)[(addr + i) % PAGE_SIZE] = (value >> (BYTE_SIZE * i)) & MASK8;
+        }
+        return;
+    }
+    storeValue(translate(addr, true) + offset, value, bytes);
+}
+
+// Read a value of 4 or 8 bytes, aligned or not
+uint64_t readMemory(uint64_t addr, int bytes)
+{
+    uint8_t *data = lookupTLB(addr, bytes, false);
+    return (data != NULL) ? loadValue(data, bytes) : readSlow(addr, bytes);
+}
+
+// Write the low 4 or 8 bytes of value, aligned or not
+void writeMemory(uint64_t addr, uint64_t value, int bytes)
+{
+    uint8_t *data = lookupTLB(addr, bytes, true);
+    if (data != NULL) {
+        storeValue(data, value, bytes);
+    } else {
+        writeSlow(addr, value, bytes);
+    }
+}
+
+// Forget every cached translation
+void flushTLB(void)
+{
+    memset(state->memory->tlb, 0, sizeof(state->memory->tlb));
+}
+
+// Copy a buffer into memory, e.g. the loaded program
+void copyToMemory(uint64_t addr, const uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        size_t offset = addr % PAGE_SIZE;
+        size_t chunk = (size < PAGE_SIZE - offset) ? size : PAGE_SIZE - offset;
+        memcpy(translate(addr, true) + offset, data, chunk);
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+static void visitTable(Entry *table, int level, uint64_t base, PageVisitor visit, void *context)
+{
+    int shift = ROOT_SHIFT - (level + 1) * LEVEL_BITS;
+    if (level == NUM_LEVELS - 1) {
+        LeafTable *leaf = (LeafTable *)table;
+        for (size_t word = 0; word < LEVEL_ENTRIES / BITMAP_WORD_BITS; word++) {
+            uint64_t bits = leaf->dirty[word];
+            for (size_t index = word * BITMAP_WORD_BITS; bits != 0; index++, bits >>= 1) {
+                if (bits & 1) {
+                    visit(base | ((uint64_t)index << shift), leaf->pages[index].page, context);
+                }
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < LEVEL_ENTRIES; i++) {
+        if (table[i].table != NULL) {
+            visitTable(table[i].table, level + 1, base | ((uint64_t)i << shift), visit, context);
+        }
+    }
+}
+
+// Start a new epoch, in which firstWrite is called with the contents of each page before
+// it is first written to; NULL to stop watching writes
+void protectPages(PageVisitor firstWrite, void *context)
+{
+    struct Memory *memory = state->memory;
+    memory->firstWrite = firstWrite;
+    memory->context = context;
+    memory->epoch++;
+    for (int i = 0; i < TLB_ENTRIES; i++) {
+        memory->tlb[i].writable = (firstWrite == NULL);
+    }
+}
+
+// Visit every dirty page in address order
+void forEachDirtyPage(PageVisitor visit, void *context)
+{
+    for (uint64_t i = 0; i < ROOT_ENTRIES; i++) {
+        Entry *entry = &state->memory->root[i];
+        if (entry->table != NULL) {
+            visitTable(entry->table, 0, i << ROOT_SHIFT, visit, context);
+        }
+    }
+}
+
+static void freeTable(Entry *entry, int level)
+{
+    if (level == NUM_LEVELS) {
+        free(entry->page);
+        entry->page = NULL;
+        return;
+    }
+    if (entry->table == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < LEVEL_ENTRIES; i++) {
+        freeTable(&entry->table[i], level + 1);
+    }
+    free(entry->table);
+    entry->table = NULL;
+}
+
+// Free every page, leaving the whole address space zeroed
+void clearMemory(void)
+{
+    for (size_t i = 0; i < ROOT_ENTRIES; i++) {
+        freeTable(&state->memory->root[i], 0);
+    }
+    flushTLB();
+}
+
+// Address space of a new emulator, empty until written to
+struct Memory *createMemory(void)
+{
+    return calloc(1, sizeof(struct Memory));
+}
+
+// Free the address space of the current emulator
+void freeMemory(void)
+{
+    clearMemory();
+    free(state->memory);
+    state->memory = NULL;
+}
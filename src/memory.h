@@ -0,0 +1,28 @@
+// Sparse guest memory over the whole 64-bit address space, allocated a page at a time
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PAGE_BITS 12
+#define PAGE_SIZE (1 << PAGE_BITS) // 4KB
+
+// Called with the address and contents of a page
+typedef void (*PageVisitor)(uint64_t addr, const uint8_t *page, void *context);
+
+
+// Prototypes
+extern uint64_t readMemory(uint64_t addr, int bytes);
+extern void writeMemory(uint64_t addr, uint64_t value, int bytes);
+extern void copyToMemory(uint64_t addr, const uint8_t *data, size_t size);
+extern void forEachDirtyPage(PageVisitor visit, void *context);
+extern void protectPages(PageVisitor firstWrite, void *context);
+extern void flushTLB(void);
+extern void clearMemory(void);
+extern struct Memory *createMemory(void);
+extern void freeMemory(void);
+
+#endif
@@ -31,6 +31,9 @@ static void handleUndefLabel(int i)
         case bu: // Branch Unconditional
             putBits(&instruction, &offset, B_SIMM26_OFFSET, B_SIMM26_LEN);
             break;
+        case bt: // Test and Branch
+            putBits(&instruction, &offset, B_SIMM14_OFFSET, B_SIMM14_LEN);
+            break;
     }
     binaryInstr[entry->PC] = instruction;
 }
@@ -12,7 +12,8 @@
 enum undefType {
     ll, // load literal
     bu, // branch unconditional
-    bc  // branch conditional
+    bc, // branch conditional, compare and branch
+    bt  // test and branch
  };
 
 // One Pass structure
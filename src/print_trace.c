@@ -0,0 +1,97 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "format.h"
+#include "io.h"
+#include "trace.h"
+
+#define TEXT_COLUMN 28 // width of the instruction column
+
+
+// Prints a trace written by emulate --trace as text, one line per retired instruction,
+// disassembling the words of the binary when it is given
+
+// Little-endian word of the binary at pc, 0 beyond its end
+static uint32_t wordAt(const uint8_t *program, size_t size, uint64_t pc)
+{
+    uint32_t word = 0;
+    for (int i = 0; i < INSTR_BYTES && pc + i < size; i++) {
+        word |= (uint32_t)program[pc + i] << (BYTE_SIZE * i);
+    }
+    return word;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        EXIT_PROGRAM("Provide a trace file and optionally the traced binary.");
+    }
+    FILE *input = loadInputFile(argv[1], NULL, "rb");
+    size_t size;
+    uint8_t *data = readWholeFile(input, &size);
+    fclose(input);
+    if (data == NULL || size < TRACE_MAGIC_BYTES || memcmp(data, TRACE_MAGIC, TRACE_MAGIC_BYTES) != 0) {
+        EXIT_PROGRAM("This is not a trace file.");
+    }
+    uint8_t *program = NULL;
+    size_t programSize = 0;
+    if (argc > 2) {
+        FILE *binary = loadInputFile(argv[2], NULL, "rb");
+        program = readWholeFile(binary, &programSize);
+        fclose(binary);
+    }
+
+    uint64_t pc = 0;
+    size_t offset = TRACE_MAGIC_BYTES;
+    while (offset < size) {
+        int flags;
+        int reg;
+        uint64_t value;
+        uint64_t address;
+        uint64_t stored;
+        int reg2;
+        uint64_t value2;
+        size_t length = readTraceRecord(data + offset, size - offset, &pc, &flags, &reg, &value, &address, &stored,
+                                        &reg2, &value2);
+        if (length == 0) {
+            fprintf(stderr, "Truncated record at offset %zu.\n", offset);
+            break;
+        }
+        offset += length;
+
+        printf("0x%08" PRIx64, pc);
+        if (program != NULL) {
+            char text[MAX_INSTR_TEXT];
+            formatWord(wordAt(program, programSize, pc), pc, text, sizeof(text));
+            if (flags & ~TRACE_JUMP) {
+                printf("  %-*s", TEXT_COLUMN, text);
+            } else {
+                printf("  %s", text);
+            }
+        }
+        if (flags & TRACE_REGISTER) {
+            printf("  x%d = 0x%016" PRIx64, reg, value);
+        }
+        if ((flags & TRACE_PAIR) && (flags & TRACE_LOAD)) {
+            printf("  x%d = 0x%016" PRIx64, reg2, value2);
+        }
+        if (flags & TRACE_LOAD) {
+            printf("  from [0x%08" PRIx64 "]", address);
+        } else if (flags & TRACE_STORE) {
+            printf("  [0x%08" PRIx64 "] = 0x%016" PRIx64, address, stored);
+            if (flags & TRACE_PAIR) {
+                printf(", 0x%016" PRIx64, value2);
+            }
+        }
+        printf("\n");
+        pc += INSTR_BYTES;
+    }
+    free(program);
+    free(data);
+    return EXIT_SUCCESS;
+}
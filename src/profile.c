@@ -0,0 +1,205 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "decoders.h"
+#include "format.h"
+#include "memory.h"
+#include "profile.h"
+#include "structs.h"
+#include "utils_em.h"
+
+#define NUM_SITES (MEMORY_SIZE / INSTR_BYTES)
+#define TEXT_COLUMN 28 // width of the instruction column
+#define MAX_DETAIL_TEXT 64
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Counts of every instruction word, indexed by PC / 4
+struct Profile {
+    uint64_t executions[NUM_SITES];
+    uint64_t taken[NUM_SITES]; // executions that did not continue at the next word
+};
+
+bool initializeProfile(void)
+{
+    state->profile = calloc(1, sizeof(struct Profile));
+    return state->profile != NULL;
+}
+
+// Forget every count, e.g. before another program is loaded
+void clearProfile(void)
+{
+    if (state->profile != NULL) {
+        memset(state->profile, 0, sizeof(struct Profile));
+    }
+}
+
+// Count one execution of the instruction at pc, which continued at nextPC
+void countInstruction(uint64_t pc, uint64_t nextPC)
+{
+    struct Profile *profile = state->profile;
+    if (profile != NULL && pc < MEMORY_SIZE) {
+        profile->executions[pc / INSTR_BYTES]++;
+        profile->taken[pc / INSTR_BYTES] += (nextPC != pc + INSTR_BYTES);
+    }
+}
+
+// Count runs of the straight-line code at start, taken of which left through its final branch
+void countBlock(uint64_t start, int length, uint64_t runs, uint64_t taken)
+{
+    struct Profile *profile = state->profile;
+    if (profile == NULL || length == 0 || start + length * INSTR_BYTES > MEMORY_SIZE) {
+        return;
+    }
+    uint64_t site = start / INSTR_BYTES;
+    for (int i = 0; i < length; i++) {
+        profile->executions[site + i] += runs;
+    }
+    profile->taken[site + length - 1] += taken;
+}
+
+static int compareSites(const void *a, const void *b)
+{
+    const uint64_t *executions = state->profile->executions;
+    uint32_t siteA = *(const uint32_t *)a;
+    uint32_t siteB = *(const uint32_t *)b;
+    if (executions[siteA] != executions[siteB]) {
+        return (executions[siteA] < executions[siteB]) ? 1 : -1;
+    }
+    return (siteA > siteB) - (siteA < siteB);
+}
+
+// Report every executed instruction, hottest first, decoded from the memory as it is now
+void writeProfile(FILE *file)
+{
+    struct Profile *profile = state->profile;
+    if (profile == NULL) {
+        return;
+    }
+    uint32_t *sites = malloc(NUM_SITES * sizeof(uint32_t));
+    if (sites == NULL) {
+        return;
+    }
+    int numSites = 0;
+    for (uint32_t site = 0; site < NUM_SITES; site++) {
+        if (profile->executions[site] != 0) {
+            sites[numSites++] = site;
+        }
+    }
+    qsort(sites, numSites, sizeof(uint32_t), compareSites);
+
+    fprintf(file, "Instructions retired: %" PRIu64 "\n", state->retired);
+    fprintf(file, "%12s  %-10s  %-*s  %s\n", "executions", "address", TEXT_COLUMN, "instruction", "detail");
+    for (int i = 0; i < numSites; i++) {
+        uint64_t addr = (uint64_t)sites[i] * INSTR_BYTES;
+        uint64_t executions = profile->executions[sites[i]];
+        uint32_t word = readMemory(addr, INSTR_BYTES);
+        char text[MAX_INSTR_TEXT];
+        formatWord(word, addr, text, sizeof(text));
+
+        // Branch outcomes and memory accesses of the site
+        char detail[MAX_DETAIL_TEXT] = "";
+        Instruction instruction = { .instructionType = isDPI };
+        if (isDecodable(word)) {
+            decode(&word, &instruction, getBits);
+            if (instruction.instructionType == isB) {
+                uint64_t taken = profile->taken[sites[i]];
+                snprintf(detail, sizeof(detail), "taken %" PRIu64 ", not taken %" PRIu64, taken, executions - taken);
+            } else if (instruction.instructionType == isSDT) {
+                bool isLoad = !instruction.sdt.mode || instruction.sdt.l;
+                snprintf(detail, sizeof(detail), "%s %" PRIu64, isLoad ? "loads" : "stores", executions);
+            }
+        }
+        fprintf(file, "%12" PRIu64 "  0x%08" PRIx64 "  ", executions, addr);
+        if (detail[0] != '\0') {
+            fprintf(file, "%-*s  %s\n", TEXT_COLUMN, text, detail);
+        } else {
+            fprintf(file, "%s\n", text);
+        }
+    }
+    free(sites);
+}
+
+// Add executions of instruction to the class it belongs to
+static void classifyInstruction(const Instruction *instruction, uint64_t executions, uint64_t taken,
+                                EmulatorStats *stats)
+{
+    switch (instruction->instructionType) {
+        case isDPI:
+            *((instruction->dpi.opi == WIDEMOVE) ? &stats->wideMove : &stats->dpiArithmetic) += executions;
+            break;
+        case isDPR:
+            if (instruction->dpr.m && instruction->dpr.opr == DPR_SELECT) {
+                stats->conditionalSelect += executions;
+            } else if (instruction->dpr.m && instruction->dpr.opr == DPR_DIVIDE) {
+                stats->divide += executions;
+            } else if (instruction->dpr.m) {
+                stats->multiply += executions;
+            } else {
+                *(instruction->dpr.armOrLog ? &stats->dprArithmetic : &stats->dprLogical) += executions;
+            }
+            break;
+        case isSDT: {
+            const struct SDT *sdt = &instruction->sdt;
+            uint64_t bytes = executions * (sdt->sf ? MODE64_BYTES : MODE32_BYTES) * (sdt->pair ? 2 : 1);
+            if (sdt->pair) {
+                stats->pairs += executions;
+            } else if (!sdt->mode) {
+                stats->loadLiteral += executions;
+            } else if (sdt->u) {
+                stats->unsignedOffset += executions;
+            } else if (sdt->offmode) {
+                stats->registerOffset += executions;
+            } else {
+                *(sdt->i ? &stats->preIndex : &stats->postIndex) += executions;
+            }
+            *((!sdt->mode || sdt->l) ? &stats->bytesLoaded : &stats->bytesStored) += bytes;
+            break;
+        }
+        case isB:
+            if (instruction->b.type == BRANCH_UNCONDITIONAL || instruction->b.type == BRANCH_LINK) {
+                stats->branchUnconditional += executions;
+            } else if (instruction->b.type != BRANCH_REGISTER) { // Conditional, compare and test
+                stats->branchConditional += executions;
+            } else {
+                stats->branchRegister += executions;
+            }
+            stats->takenBranches += taken;
+            break;
+    }
+}
+
+// Totals of the profile, every site decoded from the memory as it is now
+bool summarizeProfile(EmulatorStats *stats)
+{
+    struct Profile *profile = state->profile;
+    memset(stats, 0, sizeof(EmulatorStats));
+    stats->retired = state->retired;
+    if (profile == NULL) {
+        return false;
+    }
+    for (uint32_t site = 0; site < NUM_SITES; site++) {
+        if (profile->executions[site] == 0) {
+            continue;
+        }
+        uint32_t word = readMemory((uint64_t)site * INSTR_BYTES, INSTR_BYTES);
+        Instruction instruction = { .instructionType = isDPI };
+        if (isDecodable(word)) {
+            decode(&word, &instruction, getBits);
+            classifyInstruction(&instruction, profile->executions[site], profile->taken[site], stats);
+        }
+    }
+    return true;
+}
+
+void freeProfile(void)
+{
+    free(state->profile);
+    state->profile = NULL;
+}
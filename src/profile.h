@@ -0,0 +1,21 @@
+// Per-PC execution profile, counted in flat arrays over the instruction cache region
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "libemulate.h"
+
+
+// Prototypes
+extern bool initializeProfile(void);
+extern void clearProfile(void);
+extern void countInstruction(uint64_t pc, uint64_t nextPC);
+extern void countBlock(uint64_t start, int length, uint64_t runs, uint64_t taken);
+extern void writeProfile(FILE *file);
+extern bool summarizeProfile(EmulatorStats *stats);
+extern void freeProfile(void);
+
+#endif
@@ -0,0 +1,156 @@
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "sample.h"
+#include "structs.h"
+
+#define SAMPLE_BUFFER_WORDS (64 * 1024)
+#define MAX_RECORD_WORDS (MAX_CALL_DEPTH + 2)
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Functions entered and not yet returned from, following the compiler convention: a call
+// is bl or blr, a return is ret or br x30
+struct CallStack {
+    uint32_t entries[MAX_CALL_DEPTH];  // address each function was entered at
+    volatile int depth;
+    int hidden; // calls deeper than MAX_CALL_DEPTH, not recorded
+};
+
+// The sampled emulator and the samples not yet written, shared with the signal handler
+static struct EmulatorState *sampled = NULL;
+static int sampleFile = -1;
+static uint32_t buffer[SAMPLE_BUFFER_WORDS];
+static volatile int used = 0;
+
+bool initializeCallStack(void)
+{
+    state->callStack = calloc(1, sizeof(struct CallStack));
+    return state->callStack != NULL;
+}
+
+void clearCallStack(void)
+{
+    if (state->callStack != NULL) {
+        state->callStack->depth = 0;
+        state->callStack->hidden = 0;
+    }
+}
+
+// Update the call stack after instruction, if it is a call or a return
+void trackBranch(const Instruction *instruction)
+{
+    struct CallStack *stack = state->callStack;
+    if (stack == NULL || instruction->instructionType != isB) {
+        return;
+    }
+    const struct B *b = &instruction->b;
+    // Only bl and blr call: x30 keeps its old return address after a ret, so a plain b never does
+    bool isCall = b->type == BRANCH_LINK || (b->type == BRANCH_REGISTER && b->opc == BLR_OPC);
+    if (!isCall && b->type == BRANCH_REGISTER && (b->opc == RET_OPC || b->xn == LINK_REGISTER)) {
+        if (stack->hidden > 0) {
+            stack->hidden--;
+        } else if (stack->depth > 0) {
+            stack->depth--;
+        }
+    } else if (isCall) {
+        if (stack->depth == MAX_CALL_DEPTH) {
+            stack->hidden++;
+            return;
+        }
+        // The entry is filled in before the handler can see it
+        stack->entries[stack->depth] = state->PC;
+        atomic_signal_fence(memory_order_release);
+        stack->depth++;
+    }
+}
+
+static void flushSamples(void)
+{
+    size_t bytes = used * sizeof(uint32_t);
+    const uint8_t *data = (const uint8_t *)buffer;
+    while (bytes > 0) {
+        ssize_t written = write(sampleFile, data, bytes);
+        if (written <= 0) {
+            break;
+        }
+        data += written;
+        bytes -= written;
+    }
+    used = 0;
+}
+
+// Record the PC and call stack of the sampled emulator; only async-signal-safe calls are made
+static void takeSample(int signalNumber)
+{
+    if (sampled == NULL) {
+        return;
+    }
+    if (used + MAX_RECORD_WORDS > SAMPLE_BUFFER_WORDS) {
+        flushSamples();
+    }
+    struct CallStack *stack = sampled->callStack;
+    int depth = (stack != NULL) ? stack->depth : 0;
+    atomic_signal_fence(memory_order_acquire);
+    buffer[used] = sampled->PC;
+    buffer[used + 1] = depth;
+    for (int i = 0; i < depth; i++) {
+        buffer[used + 2 + i] = stack->entries[i];
+    }
+    used += 2 + depth;
+}
+
+// Begin a sample file taken every interval microseconds
+bool writeSampleHeader(int fd, uint32_t interval)
+{
+    uint8_t header[SAMPLE_MAGIC_BYTES + sizeof(uint32_t)];
+    memcpy(header, SAMPLE_MAGIC, SAMPLE_MAGIC_BYTES);
+    memcpy(header + SAMPLE_MAGIC_BYTES, &interval, sizeof(uint32_t));
+    return write(fd, header, sizeof(header)) == sizeof(header);
+}
+
+// Sample the current emulator every interval microseconds of CPU time until stopSampling,
+// appending the samples to fd; only one emulator can be sampled at a time
+bool startSampling(int fd, uint32_t interval)
+{
+    sampleFile = fd;
+    sampled = state;
+    used = 0;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = takeSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct itimerval timer = {
+        .it_interval = { .tv_sec = interval / 1000000, .tv_usec = interval % 1000000 },
+        .it_value = { .tv_sec = interval / 1000000, .tv_usec = interval % 1000000 }
+    };
+    return sigaction(SIGPROF, &action, NULL) == 0 && setitimer(ITIMER_PROF, &timer, NULL) == 0;
+}
+
+// Stop the timer and write the remaining samples
+void stopSampling(void)
+{
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    signal(SIGPROF, SIG_IGN);
+    flushSamples();
+    sampled = NULL;
+    sampleFile = -1;
+}
+
+void freeCallStack(void)
+{
+    free(state->callStack);
+    state->callStack = NULL;
+}
@@ -0,0 +1,28 @@
+// Timer-driven sampling of the guest PC and call stack
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "structs.h"
+
+#define SAMPLE_MAGIC "EMSAMPLE" // first bytes of a sample file
+#define SAMPLE_MAGIC_BYTES 8
+#define MAX_CALL_DEPTH 64
+
+// A sample file is the magic, the sampling interval in microseconds as a uint32_t, then one
+// record per sample: the PC, the call depth and the entry address of every function on the
+// call stack from the outermost, all as uint32_t in host byte order
+
+
+// Prototypes
+extern bool initializeCallStack(void);
+extern void clearCallStack(void);
+extern void trackBranch(const Instruction *instruction);
+extern bool writeSampleHeader(int fd, uint32_t interval);
+extern bool startSampling(int fd, uint32_t interval);
+extern void stopSampling(void);
+extern void freeCallStack(void);
+
+#endif
@@ -0,0 +1,129 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "execute.h"
+#include "memory.h"
+#include "snapshot.h"
+#include "status.h"
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Addresses of the pages a snapshot saves
+typedef struct {
+    uint64_t *addrs;
+    uint32_t count;
+    uint32_t capacity;
+} PageList;
+
+static const uint8_t zeroPage[PAGE_SIZE];
+
+// Offset of the first page in a snapshot of numPages pages
+static uint64_t pagesOffset(uint32_t numPages)
+{
+    uint64_t end = sizeof(SnapshotHeader) + (uint64_t)numPages * sizeof(uint64_t);
+    return (end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+// Pages left all zero are not saved
+static void listPage(uint64_t addr, const uint8_t *page, void *context)
+{
+    PageList *list = context;
+    if (list->addrs == NULL && list->capacity != 0) {
+        return; // an earlier allocation failed
+    }
+    if (memcmp(page, zeroPage, PAGE_SIZE) == 0) {
+        return;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity == 0) ? 64 : 2 * list->capacity;
+        uint64_t *addrs = realloc(list->addrs, list->capacity * sizeof(uint64_t));
+        if (addrs == NULL) {
+            free(list->addrs);
+            list->addrs = NULL;
+            return;
+        }
+        list->addrs = addrs;
+    }
+    list->addrs[list->count++] = addr;
+}
+
+static void writePage(uint64_t addr, const uint8_t *page, void *context)
+{
+    if (memcmp(page, zeroPage, PAGE_SIZE) != 0) {
+        fwrite(page, 1, PAGE_SIZE, context);
+    }
+}
+
+// Save the registers, flags and every non-zero page of the current emulator to file
+bool writeSnapshot(FILE *file)
+{
+    PageList list = { NULL, 0, 0 };
+    forEachDirtyPage(listPage, &list);
+    if (list.addrs == NULL && list.capacity != 0) {
+        return false;
+    }
+
+    evaluateFlags();
+    SnapshotHeader header = {
+        .version = SNAPSHOT_VERSION,
+        .numPages = list.count,
+        .retired = state->retired,
+        .pc = state->PC,
+        .sp = state->SP,
+        .zr = state->ZR,
+        .flags = (state->pstate.N ? SNAPSHOT_N : 0) | (state->pstate.Z ? SNAPSHOT_Z : 0)
+               | (state->pstate.C ? SNAPSHOT_C : 0) | (state->pstate.V ? SNAPSHOT_V : 0)
+    };
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    memcpy(header.registers, state->R, sizeof(header.registers));
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(list.addrs, sizeof(uint64_t), list.count, file);
+    uint64_t padding = pagesOffset(list.count) - sizeof(header) - (uint64_t)list.count * sizeof(uint64_t);
+    fwrite(zeroPage, 1, padding, file);
+    forEachDirtyPage(writePage, file);
+    free(list.addrs);
+    return !ferror(file);
+}
+
+// Copy the snapshot into the current emulator, whose memory is all zero
+void readSnapshot(const uint8_t *snapshot, size_t size)
+{
+    SnapshotHeader header;
+    if (size < sizeof(header)) {
+        raiseError(EMULATE_ERROR_BAD_SNAPSHOT, "The snapshot is truncated.");
+    }
+    memcpy(&header, snapshot, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        raiseError(EMULATE_ERROR_BAD_SNAPSHOT, "This is not a snapshot.");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        raiseError(EMULATE_ERROR_BAD_SNAPSHOT, "The snapshot was written by another version.");
+    }
+    uint64_t offset = pagesOffset(header.numPages);
+    if (offset + (uint64_t)header.numPages * PAGE_SIZE > size) {
+        raiseError(EMULATE_ERROR_BAD_SNAPSHOT, "The snapshot is truncated.");
+    }
+
+    const uint8_t *addrs = snapshot + sizeof(header);
+    for (uint32_t i = 0; i < header.numPages; i++) {
+        uint64_t addr;
+        memcpy(&addr, addrs + i * sizeof(uint64_t), sizeof(uint64_t));
+        copyToMemory(addr, snapshot + offset + (uint64_t)i * PAGE_SIZE, PAGE_SIZE);
+    }
+    state->retired = header.retired;
+    state->PC = header.pc;
+    state->SP = header.sp;
+    state->ZR = header.zr;
+    memcpy(state->R, header.registers, sizeof(header.registers));
+    state->pstate.N = header.flags & SNAPSHOT_N;
+    state->pstate.Z = header.flags & SNAPSHOT_Z;
+    state->pstate.C = header.flags & SNAPSHOT_C;
+    state->pstate.V = header.flags & SNAPSHOT_V;
+    state->flagOp.kind = FLAGS_EVALUATED;
+}
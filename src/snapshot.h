@@ -0,0 +1,42 @@
+// Snapshots of the registers, flags and non-zero memory of an emulator
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "constants.h"
+
+#define SNAPSHOT_MAGIC "EMSNAPSH"
+#define SNAPSHOT_VERSION 1
+
+// Flags of SnapshotHeader
+#define SNAPSHOT_N 8
+#define SNAPSHOT_Z 4
+#define SNAPSHOT_C 2
+#define SNAPSHOT_V 1
+
+// A snapshot is this header, the address of every saved page as a uint64_t, then the
+// pages themselves from the first page boundary after the addresses, so that a mapped
+// snapshot can be copied from directly; all in host byte order
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t numPages;
+    uint64_t retired;
+    int64_t pc;
+    int64_t sp;
+    int64_t registers[NUM_OF_REGISTERS];
+    int64_t zr;
+    uint32_t flags;
+    uint32_t reserved;
+} SnapshotHeader;
+
+
+// Prototypes
+extern bool writeSnapshot(FILE *file);
+extern void readSnapshot(const uint8_t *snapshot, size_t size);
+
+#endif
@@ -0,0 +1,22 @@
+// Status codes of the emulator library and the errors raised while emulating
+
+#ifndef STATUS_H
+#define STATUS_H
+
+typedef enum {
+    EMULATE_OK,                // the call succeeded, a run reached the halt instruction
+    EMULATE_BUDGET_EXHAUSTED,  // a run stopped after its instruction budget
+    EMULATE_ERROR_EMPTY_PROGRAM,
+    EMULATE_ERROR_OUT_OF_MEMORY,
+    EMULATE_ERROR_UNDEFINED,   // a word that does not decode to an instruction was executed
+    EMULATE_ERROR_UNSUPPORTED, // an instruction outside the supported subset was executed
+    EMULATE_ERROR_DEVICE,      // a device could not be mapped
+    EMULATE_ERROR_BAD_SNAPSHOT, // a snapshot is truncated or from another version
+    EMULATE_ERROR_OUT_OF_HISTORY // the state asked for precedes the oldest checkpoint kept
+} EmulateStatus;
+
+
+// Prototypes
+extern _Noreturn void raiseError(EmulateStatus status, const char *message);
+
+#endif
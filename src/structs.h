@@ -31,18 +31,24 @@ struct DPI {
     uint8_t rd; // destination register
 };
 
+// Condition of b.cond and the conditional selects
+struct Condition {
+    uint8_t tag; // encoding of mnemonic
+    bool neg;    // negate condition
+};
+
 // Data Processing Register
 struct DPR {
     bool sf;     // bit-width: 0 - 32-bit, 1 - 64-bit
     uint8_t opc; // opcode
-    bool m;      // multiply flag
+    bool m;      // multiply, conditional select or divide flag
     union { // opr
         struct { // arithmetic, bit-logic
             bool armOrLog; // 0 - logical, 1 - arithmetic
             uint8_t shift;
             bool n;
         };
-        uint8_t opr; // multiply
+        uint8_t opr; // 1000 - multiply, 0100 - conditional select, 0110 - divide
     };
     uint8_t rm;
     union {
@@ -51,6 +57,11 @@ struct DPR {
             bool x;
             uint8_t ra;
         };
+        struct { // conditional select
+            struct Condition cond;
+            uint8_t op2; // 0 - csel and csinv, 1 - csinc and csneg
+        };
+        uint8_t opcode; // divide: 000010 - udiv, 000011 - sdiv
     };
     uint8_t rn;
     uint8_t rd; // destination register
@@ -60,6 +71,7 @@ struct DPR {
 struct SDT {
     bool mode; // 1 - single data transfer, 0 - load literal
     bool sf;   // load size: 0 - 32-bit, 1 - 64-bit
+    bool pair; // transfers rt and rt2 to consecutive words
     union {
         struct { // single data transfer
             bool u;       // unsigned offset flag
@@ -77,6 +89,11 @@ struct SDT {
                     bool bit; // not used in this subset
                 };
                 uint16_t imm12; // unsigned offset
+                struct { // pair
+                    int16_t simm7;
+                    uint8_t rt2;
+                    uint8_t index; // 1 - post-index, 2 - signed offset, 3 - pre-index
+                };
             };
             uint8_t xn;
         };
@@ -87,20 +104,25 @@ struct SDT {
 
 // Branch
 struct B {
-    uint8_t type; // 0 - unconditional, 1 - conditional, 3 - register
+    uint8_t type; // 0 - unconditional, 1 - conditional, 2 - with link, 3 - register, 4 - compare, 5 - test
     union {
-        int32_t simm26; // unconditional
+        int32_t simm26; // unconditional, with link
         struct { // register
             bool bit;
+            uint8_t opc; // 0 - br, 1 - blr, 2 - ret
             uint8_t reg; // not used in this subset
             uint8_t xn;
         };
         struct { // conditiona;
             int32_t simm19;
-            struct {
-                uint8_t tag; // encoding of mnemonic
-                bool neg;    // negate condition
-            } cond;
+            struct Condition cond;
+        };
+        struct { // compare and test
+            int32_t simm;  // simm19 of compare, simm14 of test
+            uint8_t rt;
+            bool sf;       // compare: 64-bit register, test: bit 5 of the bit number
+            uint8_t b40;   // test: bits 0-4 of the bit number
+            bool nonzero;  // cbnz and tbnz
         };
     };
 };
@@ -0,0 +1,328 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "libemulate.h"
+#include "structs.h"
+#include "timing.h"
+
+#define ISSUE_WIDTH 2
+#define MISPREDICT_PENALTY 7 // cycles to refill the pipeline behind a wrongly predicted branch
+
+// Cycles until the result of each class of instruction can be read
+#define ALU_LATENCY 1
+#define SHIFTED_LATENCY 2    // with a shifted register operand
+#define MULTIPLY_LATENCY 3
+#define MULTIPLY64_LATENCY 5
+#define DIVIDE_LATENCY 12    // the iterative divider, at its worst
+#define LOAD_LATENCY 3       // an L1 hit, so a dependent instruction right after waits two cycles
+
+#define PREDICTOR_ENTRIES 1024 // 2-bit counters of the conditional branches, indexed by address
+#define WEAKLY_NOT_TAKEN 1
+#define WEAKLY_TAKEN 2
+#define STRONGLY_TAKEN 3
+#define TARGET_ENTRIES 256     // last targets of the register branches, indexed by address
+#define RETURN_ENTRIES 8       // return addresses of the innermost calls, predicting ret
+
+// Registers of the scoreboard: R0-R30 and the zero register at 31, then SP and the flags
+#define SCORE_SP 32
+#define SCORE_FLAGS 33
+#define NUM_SCORED 34
+#define MAX_READS 3
+#define MAX_WRITES 3
+
+// Pipes that take one instruction per cycle
+#define PIPE_MEMORY 1
+#define PIPE_BRANCH 2
+#define PIPE_MULTIPLY 4
+
+
+extern _Thread_local struct EmulatorState *state;
+
+struct Timing {
+    uint64_t cycle; // cycle the last instruction issued in
+    int issued;     // instructions issued in that cycle
+    int pipes;      // pipes used in that cycle
+    uint64_t ready[NUM_SCORED]; // first cycle each register can be read in
+    bool loaded[NUM_SCORED];    // the register was last written by a load
+    uint8_t counters[PREDICTOR_ENTRIES];
+    uint64_t targets[TARGET_ENTRIES];
+    uint64_t returns[RETURN_ENTRIES]; // circular, deeper calls overwrite the oldest
+    int returnTop;
+    EmulatorTiming totals;
+};
+
+// Registers an instruction reads and writes, with the cycles until each write can be read
+typedef struct {
+    int reads[MAX_READS];
+    int numReads;
+    struct {
+        int reg;
+        int latency;
+        bool load; // the value comes from memory
+    } writes[MAX_WRITES];
+    int numWrites;
+    int pipe;
+} Operands;
+
+static void addRead(Operands *operands, int reg)
+{
+    operands->reads[operands->numReads++] = reg;
+}
+
+static void addWrite(Operands *operands, int reg, int latency, bool load)
+{
+    operands->writes[operands->numWrites].reg = reg;
+    operands->writes[operands->numWrites].latency = latency;
+    operands->writes[operands->numWrites++].load = load;
+}
+
+// Register n where index 31 is the stack pointer
+static int regOrSP(int n)
+{
+    return (n == ZR_SP) ? SCORE_SP : n;
+}
+
+// The registers each instruction uses, as execute() accesses them
+static void classify(const Instruction *instruction, Operands *operands)
+{
+    memset(operands, 0, sizeof(Operands));
+    switch (instruction->instructionType) {
+        case isDPI: {
+            const struct DPI *dpi = &instruction->dpi;
+            if (dpi->opi == ARITHMETIC) {
+                bool setsFlags = (dpi->opc == ADD_SETFLAGS || dpi->opc == SUB_SETFLAGS);
+                addRead(operands, regOrSP(dpi->rn));
+                if (!setsFlags || dpi->rd != ZR_SP) {
+                    addWrite(operands, regOrSP(dpi->rd), ALU_LATENCY, false);
+                }
+                if (setsFlags) {
+                    addWrite(operands, SCORE_FLAGS, ALU_LATENCY, false);
+                }
+            } else if (dpi->rd != ZR_SP) { // Wide move
+                if (dpi->opc == MOVE_WITH_KEEP) {
+                    addRead(operands, dpi->rd);
+                }
+                addWrite(operands, dpi->rd, ALU_LATENCY, false);
+            }
+            break;
+        }
+        case isDPR: {
+            const struct DPR *dpr = &instruction->dpr;
+            addRead(operands, dpr->rm);
+            if (dpr->m && dpr->opr == DPR_SELECT) {
+                addRead(operands, dpr->rn);
+                addRead(operands, SCORE_FLAGS);
+                if (dpr->rd != ZR_SP) {
+                    addWrite(operands, dpr->rd, ALU_LATENCY, false);
+                }
+                break;
+            }
+            if (dpr->m && dpr->opr == DPR_DIVIDE) {
+                addRead(operands, dpr->rn);
+                if (dpr->rd != ZR_SP) {
+                    addWrite(operands, dpr->rd, DIVIDE_LATENCY, false);
+                }
+                operands->pipe = PIPE_MULTIPLY;
+                break;
+            }
+            addRead(operands, (dpr->rm != ZR_SP) ? dpr->rn : ZR_SP);
+            if (dpr->m) {
+                addRead(operands, dpr->ra);
+                if (dpr->rd != ZR_SP) {
+                    addWrite(operands, dpr->rd, dpr->sf ? MULTIPLY64_LATENCY : MULTIPLY_LATENCY, false);
+                }
+                operands->pipe = PIPE_MULTIPLY;
+                break;
+            }
+            bool setsFlags = dpr->armOrLog ? (dpr->opc == ADD_SETFLAGS || dpr->opc == SUB_SETFLAGS)
+                                           : (dpr->opc == BITWISE_AND_SETFLAGS);
+            if (!setsFlags || dpr->rd != ZR_SP) {
+                addWrite(operands, dpr->rd, (dpr->operand != 0) ? SHIFTED_LATENCY : ALU_LATENCY, false);
+            }
+            if (setsFlags) {
+                addWrite(operands, SCORE_FLAGS, ALU_LATENCY, false);
+            }
+            break;
+        }
+        case isSDT: {
+            const struct SDT *sdt = &instruction->sdt;
+            operands->pipe = PIPE_MEMORY;
+            if (sdt->pair) { // Load and Store Pair
+                addRead(operands, regOrSP(sdt->xn));
+                if (sdt->index != PAIR_OFFSET) {
+                    addWrite(operands, regOrSP(sdt->xn), ALU_LATENCY, false);
+                }
+                if (sdt->l) {
+                    addWrite(operands, sdt->rt, LOAD_LATENCY, true);
+                    addWrite(operands, sdt->rt2, LOAD_LATENCY, true);
+                } else {
+                    addRead(operands, sdt->rt);
+                    addRead(operands, sdt->rt2);
+                }
+                break;
+            }
+            if (sdt->mode) {
+                addRead(operands, regOrSP(sdt->xn));
+                if (!sdt->u && sdt->offmode) { // The interpreter reads SP instead of xm when xn is 31
+                    addRead(operands, (sdt->xn == ZR_SP) ? SCORE_SP : sdt->xm);
+                } else if (!sdt->u) { // Pre/post-index writes the base back
+                    addWrite(operands, regOrSP(sdt->xn), ALU_LATENCY, false);
+                }
+                if (!sdt->l) {
+                    addRead(operands, sdt->rt);
+                }
+            }
+            if (!sdt->mode || sdt->l) {
+                addWrite(operands, sdt->rt, LOAD_LATENCY, true);
+            }
+            break;
+        }
+        case isB:
+            operands->pipe = PIPE_BRANCH;
+            if (instruction->b.type == BRANCH_CONDITIONAL) {
+                addRead(operands, SCORE_FLAGS);
+            } else if (instruction->b.type == BRANCH_COMPARE || instruction->b.type == BRANCH_TEST) {
+                addRead(operands, instruction->b.rt);
+            } else if (instruction->b.type == BRANCH_REGISTER) {
+                addRead(operands, instruction->b.xn);
+            }
+            if (instruction->b.type == BRANCH_LINK
+                || (instruction->b.type == BRANCH_REGISTER && instruction->b.opc == BLR_OPC)) {
+                addWrite(operands, LINK_REGISTER, ALU_LATENCY, false);
+            }
+            break;
+    }
+}
+
+// Whether the branch at pc was predicted to continue at nextPC, training the predictors
+static bool predict(struct Timing *timing, uint64_t pc, const struct B *b, uint64_t nextPC)
+{
+    switch (b->type) {
+        case BRANCH_CONDITIONAL:
+        case BRANCH_COMPARE:
+        case BRANCH_TEST: {
+            uint8_t *counter = &timing->counters[pc / INSTR_BYTES % PREDICTOR_ENTRIES];
+            bool taken = (nextPC != pc + INSTR_BYTES);
+            bool predicted = (*counter >= WEAKLY_TAKEN);
+            if (taken && *counter < STRONGLY_TAKEN) {
+                (*counter)++;
+            } else if (!taken && *counter > 0) {
+                (*counter)--;
+            }
+            return predicted == taken;
+        }
+        case BRANCH_LINK:
+            timing->returnTop = (timing->returnTop + 1) % RETURN_ENTRIES;
+            timing->returns[timing->returnTop] = pc + INSTR_BYTES;
+            return true;
+        case BRANCH_REGISTER: {
+            if (b->opc == RET_OPC) {
+                bool predicted = (timing->returns[timing->returnTop] == nextPC);
+                timing->returnTop = (timing->returnTop + RETURN_ENTRIES - 1) % RETURN_ENTRIES;
+                return predicted;
+            }
+            if (b->opc == BLR_OPC) {
+                timing->returnTop = (timing->returnTop + 1) % RETURN_ENTRIES;
+                timing->returns[timing->returnTop] = pc + INSTR_BYTES;
+            }
+            uint64_t *target = &timing->targets[pc / INSTR_BYTES % TARGET_ENTRIES];
+            bool predicted = (*target == nextPC);
+            *target = nextPC;
+            return predicted;
+        }
+        default:
+            return true;
+    }
+}
+
+bool initializeTiming(void)
+{
+    state->timing = malloc(sizeof(struct Timing));
+    if (state->timing == NULL) {
+        return false;
+    }
+    clearTiming();
+    return true;
+}
+
+// Issue the instruction retired at pc in the first cycle its operands are ready in with a free
+// slot and pipe, then account for a mispredicted branch
+void timeInstruction(uint64_t pc, const Instruction *instruction, uint64_t nextPC)
+{
+    struct Timing *timing = state->timing;
+    if (timing == NULL) {
+        return;
+    }
+    Operands operands;
+    classify(instruction, &operands);
+
+    uint64_t ready = 0;
+    bool waitsForLoad = false;
+    for (int i = 0; i < operands.numReads; i++) {
+        int reg = operands.reads[i];
+        if (timing->ready[reg] > ready) {
+            ready = timing->ready[reg];
+            waitsForLoad = timing->loaded[reg];
+        }
+    }
+    if (timing->issued == ISSUE_WIDTH || (timing->pipes & operands.pipe) || ready > timing->cycle) {
+        uint64_t next = timing->cycle + 1;
+        if (ready > next) {
+            if (waitsForLoad) {
+                timing->totals.loadUseStalls += ready - next;
+            }
+            next = ready;
+        }
+        timing->cycle = next;
+        timing->issued = 0;
+        timing->pipes = 0;
+    }
+    if (timing->issued > 0) {
+        timing->totals.dualIssued++;
+    }
+    timing->issued++;
+    timing->pipes |= operands.pipe;
+    for (int i = 0; i < operands.numWrites; i++) {
+        int reg = operands.writes[i].reg;
+        timing->ready[reg] = timing->cycle + operands.writes[i].latency;
+        timing->loaded[reg] = operands.writes[i].load;
+    }
+
+    if (instruction->instructionType == isB && !predict(timing, pc, &instruction->b, nextPC)) {
+        timing->totals.mispredicts++;
+        timing->cycle += MISPREDICT_PENALTY;
+        timing->issued = ISSUE_WIDTH;
+    }
+    timing->totals.instructions++;
+    timing->totals.cycles = timing->cycle + 1;
+}
+
+// Totals since the program was loaded, false unless timing
+bool summarizeTiming(EmulatorTiming *timing)
+{
+    if (state->timing == NULL) {
+        memset(timing, 0, sizeof(EmulatorTiming));
+        return false;
+    }
+    *timing = state->timing->totals;
+    return true;
+}
+
+void clearTiming(void)
+{
+    struct Timing *timing = state->timing;
+    if (timing == NULL) {
+        return;
+    }
+    memset(timing, 0, sizeof(struct Timing));
+    memset(timing->counters, WEAKLY_NOT_TAKEN, sizeof(timing->counters));
+}
+
+void freeTiming(void)
+{
+    free(state->timing);
+    state->timing = NULL;
+}
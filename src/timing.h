@@ -0,0 +1,19 @@
+// Cycle-approximate timing of the retired instructions on an in-order dual-issue core like the Cortex-A53
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "libemulate.h"
+#include "structs.h"
+
+
+// Prototypes
+extern bool initializeTiming(void);
+extern void timeInstruction(uint64_t pc, const Instruction *instruction, uint64_t nextPC);
+extern bool summarizeTiming(EmulatorTiming *timing);
+extern void clearTiming(void);
+extern void freeTiming(void);
+
+#endif
@@ -0,0 +1,266 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "constants.h"
+#include "datatypes_em.h"
+#include "execute.h"
+#include "trace.h"
+#include "structs.h"
+
+#define RING_SIZE (1024 * 1024) // bytes, a power of two
+#define WRITER_SLEEP_NS 100000  // writer pause while the ring is empty
+
+
+extern _Thread_local struct EmulatorState *state;
+
+// Single-producer ring of encoded records: the emulator thread advances head, the writer
+// thread advances tail, each only reading the other's index
+struct Trace {
+    uint8_t ring[RING_SIZE];
+    _Atomic size_t head;
+    _Atomic size_t tail;
+    atomic_bool stopping;
+    pthread_t writer;
+    FILE *file;
+    uint64_t nextPC; // PC expected of the next record
+};
+
+// Write out the ring as it fills until the trace is stopped and drained
+static void *writeTrace(void *argument)
+{
+    struct Trace *trace = argument;
+    while (true) {
+        size_t tail = atomic_load_explicit(&trace->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+        if (head == tail) {
+            if (atomic_load_explicit(&trace->stopping, memory_order_acquire)
+                && atomic_load_explicit(&trace->head, memory_order_acquire) == tail) {
+                break;
+            }
+            struct timespec pause = { .tv_sec = 0, .tv_nsec = WRITER_SLEEP_NS };
+            nanosleep(&pause, NULL);
+            continue;
+        }
+        // Up to the end of the ring at most, the rest on the next pass
+        size_t start = tail % RING_SIZE;
+        size_t length = head - tail;
+        if (length > RING_SIZE - start) {
+            length = RING_SIZE - start;
+        }
+        fwrite(trace->ring + start, 1, length, trace->file);
+        atomic_store_explicit(&trace->tail, tail + length, memory_order_release);
+    }
+    fflush(trace->file);
+    return NULL;
+}
+
+// Trace the current emulator to file from now on
+bool startTrace(FILE *file)
+{
+    struct Trace *trace = calloc(1, sizeof(struct Trace));
+    if (trace == NULL) {
+        return false;
+    }
+    trace->file = file;
+    atomic_init(&trace->head, 0);
+    atomic_init(&trace->tail, 0);
+    atomic_init(&trace->stopping, false);
+    if (fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_BYTES, file) != TRACE_MAGIC_BYTES
+        || pthread_create(&trace->writer, NULL, writeTrace, trace) != 0) {
+        free(trace);
+        return false;
+    }
+    state->trace = trace;
+    return true;
+}
+
+// Continue the trace with another program, starting at address 0
+void restartTrace(void)
+{
+    if (state->trace != NULL) {
+        state->trace->nextPC = 0;
+    }
+}
+
+// Address the instruction will load from or store to, 0 if it does not access memory
+uint64_t accessAddress(const Instruction *instruction)
+{
+    if (instruction->instructionType != isSDT) {
+        return 0;
+    }
+    const struct SDT *sdt = &instruction->sdt;
+    if (sdt->pair) {
+        return pairAddress(sdt);
+    }
+    if (!sdt->mode) {
+        return state->PC + (int64_t)sdt->simm19 * INSTR_BYTES;
+    }
+    uint64_t base = (sdt->xn == ZR_SP) ? state->SP : state->R[sdt->xn];
+    if (sdt->u) {
+        return base + sdt->imm12 * (sdt->sf ? MODE64_BYTES : MODE32_BYTES);
+    } else if (sdt->offmode) {
+        return base + ((sdt->xn == ZR_SP) ? state->SP : state->R[sdt->xm]); // as execute.c reads it
+    }
+    return base + (sdt->i ? sdt->simm9 : 0);
+}
+
+static uint8_t *putVarint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80) {
+        *out++ = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    *out++ = value;
+    return out;
+}
+
+// Append the record of the instruction just executed at pc, which accessed address
+void traceInstruction(uint64_t pc, const Instruction *instruction, uint64_t address)
+{
+    struct Trace *trace = state->trace;
+    uint8_t record[MAX_TRACE_RECORD];
+    uint8_t *out = record + 1;
+    int flags = 0;
+
+    if (pc != trace->nextPC) {
+        int64_t delta = ((int64_t)pc - (int64_t)trace->nextPC) / INSTR_BYTES;
+        flags |= TRACE_JUMP;
+        out = putVarint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    }
+    trace->nextPC = pc + INSTR_BYTES;
+
+    int reg = ZR_SP;
+    bool store = false;
+    switch (instruction->instructionType) {
+        case isDPI:
+            reg = instruction->dpi.rd;
+            break;
+        case isDPR:
+            reg = instruction->dpr.rd;
+            break;
+        case isSDT:
+            store = instruction->sdt.mode && !instruction->sdt.l;
+            reg = store ? ZR_SP : instruction->sdt.rt;
+            break;
+        case isB: // bl and blr write the return address
+            if (instruction->b.type == BRANCH_LINK
+                || (instruction->b.type == BRANCH_REGISTER && instruction->b.opc == BLR_OPC)) {
+                reg = LINK_REGISTER;
+            }
+            break;
+    }
+    if (reg != ZR_SP) {
+        flags |= TRACE_REGISTER;
+        *out++ = reg;
+        out = putVarint(out, state->R[reg]);
+    }
+    if (instruction->instructionType == isSDT) {
+        flags |= store ? TRACE_STORE : TRACE_LOAD;
+        out = putVarint(out, address);
+        if (store) {
+            uint64_t value = state->R[instruction->sdt.rt];
+            out = putVarint(out, instruction->sdt.sf ? value : (uint32_t)value);
+        }
+        if (instruction->sdt.pair) {
+            flags |= TRACE_PAIR;
+            uint64_t value = state->R[instruction->sdt.rt2];
+            *out++ = instruction->sdt.rt2;
+            out = putVarint(out, instruction->sdt.sf ? value : (uint32_t)value);
+        }
+    }
+    record[0] = flags;
+
+    // Wait for the writer while the ring is full
+    size_t length = out - record;
+    size_t head = atomic_load_explicit(&trace->head, memory_order_relaxed);
+    while (head + length - atomic_load_explicit(&trace->tail, memory_order_acquire) > RING_SIZE) {
+        sched_yield();
+    }
+    for (size_t i = 0; i < length; i++) {
+        trace->ring[(head + i) % RING_SIZE] = record[i];
+    }
+    atomic_store_explicit(&trace->head, head + length, memory_order_release);
+}
+
+// Write out the rest of the trace and stop the writer
+void stopTrace(void)
+{
+    struct Trace *trace = state->trace;
+    if (trace == NULL) {
+        return;
+    }
+    atomic_store_explicit(&trace->stopping, true, memory_order_release);
+    pthread_join(trace->writer, NULL);
+    free(trace);
+    state->trace = NULL;
+}
+
+static const uint8_t *getVarint(const uint8_t *in, const uint8_t *end, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        uint8_t byte = *in++;
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return in;
+        }
+    }
+    return NULL;
+}
+
+// Decode the record at data, pc holding the PC of the previous record plus 4 and receiving
+// that of this one; the length of the record, 0 if it is truncated
+size_t readTraceRecord(const uint8_t *data, size_t size, uint64_t *pc, int *flags,
+                       int *reg, uint64_t *value, uint64_t *address, uint64_t *stored,
+                       int *reg2, uint64_t *value2)
+{
+    const uint8_t *end = data + size;
+    const uint8_t *in = data;
+    if (in == end) {
+        return 0;
+    }
+    *flags = *in++;
+    if (*flags & TRACE_JUMP) {
+        uint64_t zigzag;
+        if ((in = getVarint(in, end, &zigzag)) == NULL) {
+            return 0;
+        }
+        int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+        *pc += delta * INSTR_BYTES;
+    }
+    if (*flags & TRACE_REGISTER) {
+        if (in == end) {
+            return 0;
+        }
+        *reg = *in++;
+        if ((in = getVarint(in, end, value)) == NULL) {
+            return 0;
+        }
+    }
+    if (*flags & (TRACE_LOAD | TRACE_STORE)) {
+        if ((in = getVarint(in, end, address)) == NULL) {
+            return 0;
+        }
+    }
+    if (*flags & TRACE_STORE) {
+        if ((in = getVarint(in, end, stored)) == NULL) {
+            return 0;
+        }
+    }
+    if (*flags & TRACE_PAIR) {
+        if (in == end) {
+            return 0;
+        }
+        *reg2 = *in++;
+        if ((in = getVarint(in, end, value2)) == NULL) {
+            return 0;
+        }
+    }
+    return in - data;
+}
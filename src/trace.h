@@ -0,0 +1,34 @@
+// Binary trace of every retired instruction, written out by a background thread
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "structs.h"
+
+#define TRACE_MAGIC "EMTRACE1" // first bytes of a trace file
+#define TRACE_MAGIC_BYTES 8
+#define MAX_TRACE_RECORD 53    // flags, PC delta, register and value, address and value, second register and value
+
+// Each record starts with a byte of these flags, followed in this order by the fields they
+// announce; every number is a LEB128 varint, the PC delta zigzag encoded
+#define TRACE_JUMP 1     // PC / 4 minus that of the word after the previous record
+#define TRACE_REGISTER 2 // register number and the value written to it
+#define TRACE_LOAD 4     // address loaded from, the value being that of the register
+#define TRACE_STORE 8    // address stored to and the value stored
+#define TRACE_PAIR 16    // second register of a pair and its value, loaded from or stored to the next word
+
+
+// Prototypes
+extern bool startTrace(FILE *file);
+extern void restartTrace(void);
+extern uint64_t accessAddress(const Instruction *instruction);
+extern void traceInstruction(uint64_t pc, const Instruction *instruction, uint64_t address);
+extern void stopTrace(void);
+extern size_t readTraceRecord(const uint8_t *data, size_t size, uint64_t *pc, int *flags,
+                              int *reg, uint64_t *value, uint64_t *address, uint64_t *stored,
+                              int *reg2, uint64_t *value2);
+
+#endif
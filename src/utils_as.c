@@ -75,6 +75,16 @@ int getShift(char *shift)
     EXIT_PROGRAM("Shift mode not supported.");
 }
 
+// Decode <cond> into its position in conditions, where position ^ 1 is the inverse
+int getCondition(char *cond)
+{
+    int pos = getPositionInArray(cond, conditions, CONDITIONS_SIZE);
+    if (pos == NOT_FOUND) {
+        EXIT_PROGRAM("Condition not supported.");
+    }
+    return pos;
+}
+
 //
 // Type Decoding Helpers
 //
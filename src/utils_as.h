@@ -14,6 +14,7 @@ extern int getImmediate(char *imm);
 extern int getRegister(char *rd);
 extern int getLiteral(char *literal, vector *symtable);
 extern int getShift(char *shift);
+extern int getCondition(char *cond);
 
 extern enum type identifyType(char *instrname);
 extern enum dpType getOpType(char **tokens, int numTokens);